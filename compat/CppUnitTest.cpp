@@ -0,0 +1,51 @@
+// Test runner for the `CppUnitTest.h` stand-in.
+// Runs every registered test method, or only those whose `class::method` name contains the first argument.
+
+#include <cstdio>
+#include <exception>
+#include <string>
+
+#include "CppUnitTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+int main(int argc, char** argv)
+{
+    const char* filter = argc > 1 ? argv[1] : "";
+    int passed = 0;
+    int failed = 0;
+
+    for (const auto& method : detail::test_methods())
+    {
+        const auto name = std::string{ method.class_name } + "::" + method.method_name;
+        if (name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        try
+        {
+            method.invoke();
+            ++passed;
+            std::printf("[ passed ] %s\n", name.c_str());
+        }
+        catch (const assert_failed& e)
+        {
+            ++failed;
+            std::printf("[ FAILED ] %s: %s\n", name.c_str(), e.message.c_str());
+        }
+        catch (const std::exception& e)
+        {
+            ++failed;
+            std::printf("[ FAILED ] %s: unhandled exception: %s\n", name.c_str(), e.what());
+        }
+        catch (...)
+        {
+            ++failed;
+            std::printf("[ FAILED ] %s: unhandled exception\n", name.c_str());
+        }
+    }
+
+    std::printf("%d passed, %d failed\n", passed, failed);
+    return failed == 0 && passed > 0 ? 0 : 1;
+}
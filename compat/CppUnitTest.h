@@ -0,0 +1,181 @@
+#pragma once
+
+// Stand-in for the subset of the Visual Studio `CppUnitTest.h` framework used by `win64.test`,
+// so that the tests of the portable headers can be built and run outside of Visual Studio.
+// Link with `CppUnitTest.cpp`, which provides `main`.
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Microsoft
+{
+    namespace VisualStudio
+    {
+        namespace CppUnitTestFramework
+        {
+            namespace detail
+            {
+                struct test_method
+                {
+                    const char* class_name;
+                    const char* method_name;
+                    void(*invoke)();
+                };
+
+                inline std::vector<test_method>& test_methods()
+                {
+                    static std::vector<test_method> methods;
+                    return methods;
+                }
+
+                inline bool register_method(const char* class_name, const char* method_name, void(*invoke)())
+                {
+                    test_methods().push_back(test_method{ class_name, method_name, invoke });
+                    return true;
+                }
+
+                template <typename T>
+                std::string to_string(const T& value)
+                {
+                    std::ostringstream stream;
+                    stream << value;
+                    return stream.str();
+                }
+
+                template <typename Char, typename CharTraits, typename Allocator>
+                std::string to_string(const std::basic_string<Char, CharTraits, Allocator>& value)
+                {
+                    std::string result;
+                    for (const auto c : value)
+                    {
+                        const auto code = static_cast<unsigned long>(c);
+                        if (code < 0x80)
+                        {
+                            result += static_cast<char>(code);
+                        }
+                        else
+                        {
+                            std::ostringstream stream;
+                            stream << "\\x{" << std::hex << code << "}";
+                            result += stream.str();
+                        }
+                    }
+                    return result;
+                }
+
+                inline std::string to_string(const std::string& value)
+                {
+                    return value;
+                }
+            }
+
+            //! Thrown by the `Assert` functions when an assertion fails.
+            struct assert_failed
+            {
+                std::string message;
+            };
+
+            class Assert
+            {
+            public:
+                template <typename T, typename U>
+                static void AreEqual(const T& expected, const U& actual, const wchar_t* message = nullptr)
+                {
+                    if (!(expected == actual))
+                    {
+                        fail("AreEqual failed. Expected <" + detail::to_string(expected) + "> Actual <" + detail::to_string(actual) + ">", message);
+                    }
+                }
+
+                template <typename T, typename U>
+                static void AreNotEqual(const T& not_expected, const U& actual, const wchar_t* message = nullptr)
+                {
+                    if (not_expected == actual)
+                    {
+                        fail("AreNotEqual failed. Both are <" + detail::to_string(actual) + ">", message);
+                    }
+                }
+
+                static void IsTrue(bool condition, const wchar_t* message = nullptr)
+                {
+                    if (!condition)
+                    {
+                        fail("IsTrue failed", message);
+                    }
+                }
+
+                static void IsFalse(bool condition, const wchar_t* message = nullptr)
+                {
+                    if (condition)
+                    {
+                        fail("IsFalse failed", message);
+                    }
+                }
+
+                static void Fail(const wchar_t* message = nullptr)
+                {
+                    fail("Fail", message);
+                }
+
+                template <typename Exception, typename Function>
+                static void ExpectException(Function function, const wchar_t* message = nullptr)
+                {
+                    try
+                    {
+                        function();
+                    }
+                    catch (const Exception&)
+                    {
+                        return;
+                    }
+                    catch (...)
+                    {
+                        fail("ExpectException failed. A different exception was thrown", message);
+                    }
+
+                    fail("ExpectException failed. No exception was thrown", message);
+                }
+
+            private:
+                static void fail(std::string description, const wchar_t* message)
+                {
+                    if (message != nullptr)
+                    {
+                        description += " - " + detail::to_string(std::wstring{ message });
+                    }
+
+                    throw assert_failed{ description };
+                }
+            };
+
+            template <typename Class, typename Name>
+            class TestClass
+            {
+            protected:
+                using test_class_type = Class;
+
+                static const char* test_class_name()
+                {
+                    return Name::value();
+                }
+            };
+        }
+    }
+}
+
+#define TEST_CLASS(className) \
+    struct className##_name \
+    { \
+        static const char* value() { return #className; } \
+    }; \
+    class className : public ::Microsoft::VisualStudio::CppUnitTestFramework::TestClass<className, className##_name>
+
+#define TEST_METHOD(methodName) \
+    static void methodName##_invoke() \
+    { \
+        test_class_type{}.methodName(); \
+    } \
+    inline static const bool methodName##_registered = \
+        ::Microsoft::VisualStudio::CppUnitTestFramework::detail::register_method(test_class_name(), #methodName, &methodName##_invoke); \
+    public: void methodName()
@@ -0,0 +1,289 @@
+#pragma once
+
+// Stand-in for the subset of the Windows API used by the `win64` headers, for building and
+// benchmarking them on other platforms. It follows the documented behavior of each function,
+// but kernel objects are simulated in-process and the system message table only knows a few
+// messages, so it is only suitable for tests and benchmarks.
+
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cwchar>
+#include <mutex>
+#include <thread>
+
+#include "winerror.h"
+
+using BOOL = int;
+using BYTE = unsigned char;
+using WORD = unsigned short;
+using DWORD = unsigned long;
+using LONG = long;
+using LONG_PTR = std::intptr_t;
+using HRESULT = long;
+using LSTATUS = long;
+using HANDLE = void*;
+using LPVOID = void*;
+using LPCVOID = const void*;
+using WCHAR = wchar_t;
+using LPWSTR = wchar_t*;
+using LPCWSTR = const wchar_t*;
+
+#define TRUE 1
+#define FALSE 0
+#define WINAPI
+#define __stdcall
+
+#define INFINITE 0xFFFFFFFFul
+#define INVALID_HANDLE_VALUE (reinterpret_cast<HANDLE>(static_cast<LONG_PTR>(-1)))
+
+#define WAIT_OBJECT_0 0x00000000ul
+#define WAIT_ABANDONED 0x00000080ul
+#define WAIT_ABANDONED_0 0x00000080ul
+#define WAIT_TIMEOUT 0x00000102ul
+#define WAIT_FAILED 0xFFFFFFFFul
+#define MAXIMUM_WAIT_OBJECTS 64
+
+#define FORMAT_MESSAGE_FROM_SYSTEM 0x00001000ul
+#define LANG_ENGLISH 0x09
+#define SUBLANG_ENGLISH_US 0x01
+#define MAKELANGID(p, s) ((static_cast<WORD>(s) << 10) | static_cast<WORD>(p))
+
+namespace compat
+{
+    inline DWORD& last_error()
+    {
+        thread_local DWORD error = ERROR_SUCCESS;
+        return error;
+    }
+
+    //! A simulated kernel event. All events share one lock, which keeps `WaitForMultipleObjects` simple.
+    struct event_object
+    {
+        bool manual_reset;
+        bool signaled;
+    };
+
+    struct kernel
+    {
+        std::mutex mutex;
+        std::condition_variable changed;
+    };
+
+    inline kernel& kernel_state()
+    {
+        static kernel instance;
+        return instance;
+    }
+
+    inline event_object* to_event(HANDLE handle)
+    {
+        return handle == nullptr || handle == INVALID_HANDLE_VALUE ? nullptr : static_cast<event_object*>(handle);
+    }
+
+    //! Whether the objects satisfy the wait, and if so, the index of the first signaled object.
+    inline bool satisfied(DWORD count, const HANDLE* handles, bool wait_all, DWORD& index)
+    {
+        for (DWORD i = 0; i < count; ++i)
+        {
+            const auto signaled = to_event(handles[i])->signaled;
+            if (signaled && !wait_all)
+            {
+                index = i;
+                return true;
+            }
+            else if (!signaled && wait_all)
+            {
+                return false;
+            }
+        }
+
+        index = 0;
+        return wait_all;
+    }
+
+    inline void consume(DWORD count, const HANDLE* handles, bool wait_all, DWORD index)
+    {
+        for (DWORD i = wait_all ? 0 : index; i < (wait_all ? count : index + 1); ++i)
+        {
+            const auto e = to_event(handles[i]);
+            if (!e->manual_reset)
+            {
+                e->signaled = false;
+            }
+        }
+    }
+
+    struct message
+    {
+        std::uint32_t code;
+        const wchar_t* text;
+    };
+
+    constexpr message messages[] = {
+        { 0, L"The operation completed successfully.\r\n" },
+        { 2, L"The system cannot find the file specified.\r\n" },
+        { 5, L"Access is denied.\r\n" },
+        { 6, L"The handle is invalid.\r\n" },
+        { 8, L"Not enough memory resources are available to process this command.\r\n" },
+        { 87, L"The parameter is incorrect.\r\n" },
+        { 258, L"The wait operation timed out.\r\n" },
+        { 0x80004001u, L"Not implemented\r\n" },
+        { 0x80004002u, L"No such interface supported\r\n" },
+        { 0x80004003u, L"Invalid pointer\r\n" },
+        { 0x80004005u, L"Unspecified error\r\n" },
+        { 0x8000FFFFu, L"Catastrophic failure\r\n" }
+    };
+}
+
+inline DWORD GetLastError()
+{
+    return compat::last_error();
+}
+
+inline void SetLastError(DWORD error)
+{
+    compat::last_error() = error;
+}
+
+inline HANDLE CreateEventW(void* /* security_attributes */, BOOL manual_reset, BOOL initial_state, LPCWSTR /* name */)
+{
+    return new compat::event_object{ manual_reset != FALSE, initial_state != FALSE };
+}
+
+#define CreateEvent CreateEventW
+
+inline BOOL SetEvent(HANDLE handle)
+{
+    const auto e = compat::to_event(handle);
+    if (e == nullptr)
+    {
+        SetLastError(ERROR_INVALID_HANDLE);
+        return FALSE;
+    }
+
+    {
+        const std::lock_guard<std::mutex> lock{ compat::kernel_state().mutex };
+        e->signaled = true;
+    }
+    compat::kernel_state().changed.notify_all();
+    return TRUE;
+}
+
+inline BOOL ResetEvent(HANDLE handle)
+{
+    const auto e = compat::to_event(handle);
+    if (e == nullptr)
+    {
+        SetLastError(ERROR_INVALID_HANDLE);
+        return FALSE;
+    }
+
+    const std::lock_guard<std::mutex> lock{ compat::kernel_state().mutex };
+    e->signaled = false;
+    return TRUE;
+}
+
+inline BOOL CloseHandle(HANDLE handle)
+{
+    const auto e = compat::to_event(handle);
+    if (e == nullptr)
+    {
+        SetLastError(ERROR_INVALID_HANDLE);
+        return FALSE;
+    }
+
+    delete e;
+    return TRUE;
+}
+
+inline DWORD WaitForMultipleObjects(DWORD count, const HANDLE* handles, BOOL wait_all, DWORD milliseconds)
+{
+    if (count == 0 || count > MAXIMUM_WAIT_OBJECTS)
+    {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return WAIT_FAILED;
+    }
+
+    for (DWORD i = 0; i < count; ++i)
+    {
+        if (compat::to_event(handles[i]) == nullptr)
+        {
+            SetLastError(ERROR_INVALID_HANDLE);
+            return WAIT_FAILED;
+        }
+    }
+
+    auto& state = compat::kernel_state();
+    std::unique_lock<std::mutex> lock{ state.mutex };
+    DWORD index = 0;
+    const auto ready = [&] { return compat::satisfied(count, handles, wait_all != FALSE, index); };
+
+    if (milliseconds == 0 && !ready())
+    {
+        return WAIT_TIMEOUT;
+    }
+    else if (milliseconds == INFINITE)
+    {
+        state.changed.wait(lock, ready);
+    }
+    else if (!state.changed.wait_for(lock, std::chrono::milliseconds{ milliseconds }, ready))
+    {
+        return WAIT_TIMEOUT;
+    }
+
+    compat::consume(count, handles, wait_all != FALSE, index);
+    return WAIT_OBJECT_0 + index;
+}
+
+inline DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds)
+{
+    return WaitForMultipleObjects(1, &handle, TRUE, milliseconds);
+}
+
+inline DWORD FormatMessageW(DWORD flags, LPCVOID /* source */, DWORD message_id, DWORD /* language_id */, LPWSTR buffer, DWORD size, void* /* arguments */)
+{
+    if (flags != FORMAT_MESSAGE_FROM_SYSTEM)
+    {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return 0;
+    }
+
+    for (const auto& m : compat::messages)
+    {
+        // `DWORD` is 64 bits on some platforms; message IDs are 32 bits.
+        if (m.code == static_cast<std::uint32_t>(message_id))
+        {
+            const auto length = static_cast<DWORD>(std::wcslen(m.text));
+            if (length >= size)
+            {
+                SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+                return 0;
+            }
+
+            std::wmemcpy(buffer, m.text, length + 1);
+            return length;
+        }
+    }
+
+    SetLastError(317); // ERROR_MR_MID_NOT_FOUND
+    return 0;
+}
+
+#define FormatMessage FormatMessageW
+
+inline void Sleep(DWORD milliseconds)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds{ milliseconds });
+}
+
+inline BOOL IsDebuggerPresent()
+{
+    return FALSE;
+}
+
+inline void DebugBreak()
+{
+    std::raise(SIGTRAP);
+}
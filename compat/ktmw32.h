@@ -0,0 +1,46 @@
+#pragma once
+
+// Stand-in for the subset of the Kernel Transaction Manager API used by `win64/ktm.hpp`.
+// Transactions are simulated as kernel objects that `CloseHandle` accepts. They do not isolate
+// anything: the transacted registry calls in `winreg.h` apply their changes immediately.
+
+#include <atomic>
+
+#include "Windows.h"
+
+namespace compat
+{
+    //! Calls to `CommitTransaction` that succeeded, so that tests can tell a commit from a rollback.
+    inline std::atomic<unsigned long> committed_transactions{ 0 };
+}
+
+#define TRANSACTION_DO_NOT_PROMOTE 0x00000001ul
+
+inline HANDLE CreateTransaction(void* /* security_attributes */, void* /* uow */, DWORD /* options */, DWORD /* isolation_level */,
+    DWORD /* isolation_flags */, DWORD /* timeout */, LPWSTR /* description */)
+{
+    return CreateEventW(nullptr, TRUE, FALSE, nullptr);
+}
+
+inline BOOL CommitTransaction(HANDLE transaction)
+{
+    if (transaction == nullptr || transaction == INVALID_HANDLE_VALUE)
+    {
+        SetLastError(ERROR_INVALID_HANDLE);
+        return FALSE;
+    }
+
+    ++compat::committed_transactions;
+    return TRUE;
+}
+
+inline BOOL RollbackTransaction(HANDLE transaction)
+{
+    if (transaction == nullptr || transaction == INVALID_HANDLE_VALUE)
+    {
+        SetLastError(ERROR_INVALID_HANDLE);
+        return FALSE;
+    }
+
+    return TRUE;
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+// Stand-in for the Windows SDK's `winerror.h`, for building the headers on other platforms.
+// `HRESULT`s are 32-bit values; on platforms where `long` is 64 bits they are sign-extended,
+// so that failure codes are negative as they are on Windows.
+
+#include <cstdint>
+
+namespace compat
+{
+    constexpr long hresult(std::uint32_t value)
+    {
+        return static_cast<long>(static_cast<std::int32_t>(value));
+    }
+
+    constexpr long hresult_from_win32(long long error)
+    {
+        return hresult(static_cast<std::uint32_t>(error)) <= 0
+            ? hresult(static_cast<std::uint32_t>(error))
+            : hresult((static_cast<std::uint32_t>(error) & 0x0000FFFF) | (7u << 16) | 0x80000000u);
+    }
+}
+
+#define ERROR_SUCCESS 0L
+#define NO_ERROR 0L
+#define ERROR_FILE_NOT_FOUND 2L
+#define ERROR_ACCESS_DENIED 5L
+#define ERROR_INVALID_HANDLE 6L
+#define ERROR_NOT_ENOUGH_MEMORY 8L
+#define ERROR_INVALID_PARAMETER 87L
+
+#define FACILITY_WIN32 7
+
+#define S_OK 0L
+#define S_FALSE 1L
+#define E_UNEXPECTED compat::hresult(0x8000FFFFu)
+#define E_NOTIMPL compat::hresult(0x80004001u)
+#define E_OUTOFMEMORY compat::hresult(0x8007000Eu)
+#define E_INVALIDARG compat::hresult(0x80070057u)
+#define E_NOINTERFACE compat::hresult(0x80004002u)
+#define E_POINTER compat::hresult(0x80004003u)
+#define E_HANDLE compat::hresult(0x80070006u)
+#define E_ABORT compat::hresult(0x80004004u)
+#define E_FAIL compat::hresult(0x80004005u)
+#define E_ACCESSDENIED compat::hresult(0x80070005u)
+#define REGDB_E_CLASSNOTREG compat::hresult(0x80040154u)
+
+#define HRESULT_FROM_WIN32(x) compat::hresult_from_win32(x)
+#define HRESULT_CODE(hr) ((hr) & 0xFFFF)
+#define SUCCEEDED(hr) (static_cast<long>(hr) >= 0)
+#define FAILED(hr) (static_cast<long>(hr) < 0)
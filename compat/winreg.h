@@ -0,0 +1,274 @@
+#pragma once
+
+// Stand-in for the subset of the registry API used by `win64/registry.hpp`.
+// The registry is simulated in-process: keys and values are kept in memory, names are compared
+// without regard to ASCII case, and transacted calls apply their changes immediately.
+
+#include <cstring>
+#include <cwctype>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "Windows.h"
+
+using REGSAM = DWORD;
+
+//! An open key: the full path of the key, folded to uppercase.
+struct HKEY__
+{
+    std::wstring path;
+};
+
+using HKEY = HKEY__*;
+
+#define HKEY_CURRENT_USER (reinterpret_cast<HKEY>(static_cast<LONG_PTR>(0x80000001)))
+#define HKEY_LOCAL_MACHINE (reinterpret_cast<HKEY>(static_cast<LONG_PTR>(0x80000002)))
+
+#define DELETE 0x00010000ul
+#define KEY_QUERY_VALUE 0x0001ul
+#define KEY_SET_VALUE 0x0002ul
+#define KEY_CREATE_SUB_KEY 0x0004ul
+#define KEY_ENUMERATE_SUB_KEYS 0x0008ul
+#define KEY_WRITE 0x20006ul
+#define KEY_READ 0x20019ul
+
+#define REG_OPTION_NON_VOLATILE 0x00000000ul
+#define REG_SZ 1ul
+#define RRF_RT_REG_SZ 0x00000002ul
+
+namespace compat
+{
+    struct registry
+    {
+        std::mutex mutex;
+
+        //! Values of each key, by full path and value name, folded to uppercase. The default value has an empty name.
+        std::map<std::wstring, std::map<std::wstring, std::wstring>> keys;
+    };
+
+    inline registry& registry_state()
+    {
+        static registry instance;
+        return instance;
+    }
+
+    inline std::wstring fold(const wchar_t* name)
+    {
+        std::wstring folded;
+        for (; name != nullptr && *name != L'\0'; ++name)
+        {
+            folded += static_cast<wchar_t>(std::towupper(static_cast<wint_t>(*name)));
+        }
+        return folded;
+    }
+
+    //! The full path of `subkey` under `key`, or an empty string if `key` is not a valid key.
+    inline std::wstring full_path(HKEY key, const wchar_t* subkey)
+    {
+        std::wstring path;
+        if (key == HKEY_CURRENT_USER)
+        {
+            path = L"HKEY_CURRENT_USER";
+        }
+        else if (key == HKEY_LOCAL_MACHINE)
+        {
+            path = L"HKEY_LOCAL_MACHINE";
+        }
+        else if (key != nullptr)
+        {
+            path = key->path;
+        }
+        else
+        {
+            return path;
+        }
+
+        if (subkey != nullptr && *subkey != L'\0')
+        {
+            path += L'\\';
+            path += fold(subkey);
+        }
+
+        return path;
+    }
+
+    inline bool is_subkey(const std::wstring& path, const std::wstring& parent)
+    {
+        return path.size() > parent.size() && path.compare(0, parent.size(), parent) == 0 && path[parent.size()] == L'\\';
+    }
+}
+
+inline LSTATUS RegCreateKeyTransactedW(HKEY key, LPCWSTR subkey, DWORD /* reserved */, LPWSTR /* class_name */, DWORD /* options */, REGSAM /* access */,
+    void* /* security_attributes */, HKEY* result, DWORD* disposition, HANDLE /* transaction */, void* /* extended_parameter */)
+{
+    auto path = compat::full_path(key, subkey);
+    if (path.empty())
+    {
+        return ERROR_INVALID_HANDLE;
+    }
+
+    auto& state = compat::registry_state();
+    const std::lock_guard<std::mutex> lock{ state.mutex };
+
+    // Create the missing keys along the path.
+    bool created = false;
+    for (auto end = path.find(L'\\'); ; end = path.find(L'\\', end + 1))
+    {
+        created = state.keys.try_emplace(path.substr(0, end)).second;
+        if (end == std::wstring::npos)
+        {
+            break;
+        }
+    }
+
+    if (disposition != nullptr)
+    {
+        *disposition = created ? 1 : 2; // `REG_CREATED_NEW_KEY` or `REG_OPENED_EXISTING_KEY`
+    }
+
+    *result = new HKEY__{ std::move(path) };
+    return ERROR_SUCCESS;
+}
+
+#define RegCreateKeyTransacted RegCreateKeyTransactedW
+
+inline LSTATUS RegOpenKeyTransactedW(HKEY key, LPCWSTR subkey, DWORD /* options */, REGSAM /* access */, HKEY* result, HANDLE /* transaction */, void* /* extended_parameter */)
+{
+    auto path = compat::full_path(key, subkey);
+    if (path.empty())
+    {
+        return ERROR_INVALID_HANDLE;
+    }
+
+    auto& state = compat::registry_state();
+    const std::lock_guard<std::mutex> lock{ state.mutex };
+
+    if (state.keys.count(path) == 0)
+    {
+        return ERROR_FILE_NOT_FOUND;
+    }
+
+    *result = new HKEY__{ std::move(path) };
+    return ERROR_SUCCESS;
+}
+
+#define RegOpenKeyTransacted RegOpenKeyTransactedW
+
+inline LSTATUS RegCloseKey(HKEY key)
+{
+    if (key == nullptr || key == HKEY_CURRENT_USER || key == HKEY_LOCAL_MACHINE)
+    {
+        return ERROR_INVALID_HANDLE;
+    }
+
+    delete key;
+    return ERROR_SUCCESS;
+}
+
+inline LSTATUS RegSetValueExW(HKEY key, LPCWSTR value_name, DWORD /* reserved */, DWORD type, const BYTE* data, DWORD size)
+{
+    if (type != REG_SZ)
+    {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    const auto path = compat::full_path(key, nullptr);
+    auto& state = compat::registry_state();
+    const std::lock_guard<std::mutex> lock{ state.mutex };
+
+    const auto found = state.keys.find(path);
+    if (found == state.keys.end())
+    {
+        return ERROR_INVALID_HANDLE;
+    }
+
+    std::wstring value(size / sizeof(wchar_t), L'\0');
+    std::memcpy(&value[0], data, value.size() * sizeof(wchar_t));
+    if (!value.empty() && value.back() == L'\0')
+    {
+        value.pop_back();
+    }
+
+    found->second[compat::fold(value_name)] = std::move(value);
+    return ERROR_SUCCESS;
+}
+
+#define RegSetValueEx RegSetValueExW
+
+inline LSTATUS RegGetValueW(HKEY key, LPCWSTR subkey, LPCWSTR value_name, DWORD flags, DWORD* type, void* data, DWORD* size)
+{
+    if (flags != RRF_RT_REG_SZ)
+    {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    const auto path = compat::full_path(key, subkey);
+    auto& state = compat::registry_state();
+    const std::lock_guard<std::mutex> lock{ state.mutex };
+
+    const auto found = state.keys.find(path);
+    if (found == state.keys.end())
+    {
+        return ERROR_FILE_NOT_FOUND;
+    }
+
+    const auto value = found->second.find(compat::fold(value_name));
+    if (value == found->second.end())
+    {
+        return ERROR_FILE_NOT_FOUND;
+    }
+
+    const auto required = static_cast<DWORD>((value->second.size() + 1) * sizeof(wchar_t));
+    if (type != nullptr)
+    {
+        *type = REG_SZ;
+    }
+
+    if (data != nullptr && *size < required)
+    {
+        *size = required;
+        return 234L; // ERROR_MORE_DATA
+    }
+    else if (data != nullptr)
+    {
+        std::memcpy(data, value->second.c_str(), required);
+    }
+
+    *size = required;
+    return ERROR_SUCCESS;
+}
+
+#define RegGetValue RegGetValueW
+
+inline LSTATUS RegDeleteTreeW(HKEY key, LPCWSTR subkey)
+{
+    const auto path = compat::full_path(key, subkey);
+    auto& state = compat::registry_state();
+    const std::lock_guard<std::mutex> lock{ state.mutex };
+
+    const auto found = state.keys.find(path);
+    if (found == state.keys.end())
+    {
+        return ERROR_FILE_NOT_FOUND;
+    }
+
+    // Deletes the subkeys and values; the key itself is only deleted if it was named by `subkey`.
+    for (auto i = state.keys.lower_bound(path + L'\\'); i != state.keys.end() && compat::is_subkey(i->first, path); )
+    {
+        i = state.keys.erase(i);
+    }
+
+    if (subkey != nullptr && *subkey != L'\0')
+    {
+        state.keys.erase(found);
+    }
+    else
+    {
+        found->second.clear();
+    }
+
+    return ERROR_SUCCESS;
+}
+
+#define RegDeleteTree RegDeleteTreeW
\ No newline at end of file
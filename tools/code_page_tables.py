@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""Generates win64/code_page_tables.hpp from Python's codec tables, which follow the Unicode.org mappings.
+
+    python3 tools/code_page_tables.py > win64/code_page_tables.hpp
+"""
+
+CODE_PAGES = [
+    ("windows_1252", "cp1252"),
+    ("windows_1251", "cp1251"),
+    ("oem_437", "cp437"),
+]
+
+UNDEFINED = 0xFFFF
+
+
+def to_unicode(codec):
+    table = []
+    for byte in range(256):
+        try:
+            table.append(ord(bytes([byte]).decode(codec)))
+        except UnicodeDecodeError:
+            table.append(UNDEFINED)
+    return table
+
+
+def reverse_pages(table):
+    """Pages of the reverse mapping for the non-ASCII characters, indexed by the high byte of the character."""
+    pages = {}
+    for byte, char in enumerate(table):
+        if byte >= 0x80 and char != UNDEFINED:
+            pages.setdefault(char >> 8, [0] * 256)[char & 0xFF] = byte
+    return pages
+
+
+def rows(values, width, per_line):
+    for i in range(0, len(values), per_line):
+        yield "                " + ", ".join(f"0x{v:0{width}X}" for v in values[i:i + per_line]) + ","
+
+
+def main():
+    print("#pragma once")
+    print()
+    print("// Generated by tools/code_page_tables.py from the Unicode.org mappings. Do not edit.")
+    print()
+    print("#include <cstdint>")
+    print()
+    print("namespace windows")
+    print("{")
+    print("    namespace locale")
+    print("    {")
+    print("        namespace detail")
+    print("        {")
+    print("            //! Mapping between a single-byte code page and UTF-16.")
+    print("            //! Bytes 0x00-0x7F are ASCII in every supported code page.")
+    print("            struct code_page_table")
+    print("            {")
+    print("                std::uint16_t to_unicode[256]; //!< 0xFFFF for bytes the code page does not define")
+    print("                std::uint8_t page_index[256]; //!< For each high byte of a character, 1 + its index into `pages`, or 0")
+    print("                const std::uint8_t (*pages)[256]; //!< Byte for each low byte of a character, or 0 if it has no mapping")
+    print("            };")
+
+    for name, codec in CODE_PAGES:
+        table = to_unicode(codec)
+        assert table[:0x80] == list(range(0x80)), f"{codec} is not ASCII-compatible"
+        pages = reverse_pages(table)
+        high_bytes = sorted(pages)
+
+        print()
+        print(f"            // {codec}")
+        print(f"            constexpr std::uint8_t {name}_pages[][256] = {{")
+        for high in high_bytes:
+            print("                {")
+            for row in rows(pages[high], 2, 16):
+                print("    " + row)
+            print("                },")
+        print("            };")
+        print()
+        print(f"            constexpr code_page_table {name}_table = {{")
+        print("                {")
+        for row in rows(table, 4, 16):
+            print("    " + row)
+        print("                },")
+        print("                {")
+        index = [0] * 256
+        for i, high in enumerate(high_bytes):
+            index[high] = i + 1
+        for row in rows(index, 2, 16):
+            print("    " + row)
+        print("                },")
+        print(f"                {name}_pages")
+        print("            };")
+
+    print("        }")
+    print("    }")
+    print("}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""Generates win64/uppercase_table.hpp, the simple uppercase mapping of the Basic Multilingual Plane.
+
+    python3 tools/uppercase_table.py > win64/uppercase_table.hpp
+
+Like the table that the registry and NTFS use to compare names, it maps each UTF-16 code unit to at most one
+code unit, following the Simple_Uppercase_Mapping field of UnicodeData.txt rather than the full mapping:
+characters with no single-character uppercase (such as U+00DF) and surrogates map to themselves, and the Greek
+letters with ypogegrammeni (such as U+1F80) map to their titlecase form (U+1F88), not to the two-character
+full uppercase (U+1F08 U+0399).
+
+The table is pinned to UNICODE_VERSION so that regenerating it with a different Python cannot silently change
+which names compare equal.
+"""
+
+import sys
+import unicodedata
+
+UNICODE_VERSION = "14.0.0"
+
+
+def uppercase(unit):
+    if 0xD800 <= unit < 0xE000:
+        return unit
+    # str.upper() is the full mapping. Where that is longer than one character, the simple mapping is either
+    # nothing or, for the letters with ypogegrammeni, the titlecase letter.
+    for mapped in (chr(unit).upper(), chr(unit).title()):
+        if len(mapped) == 1:
+            return ord(mapped) if ord(mapped) <= 0xFFFF else unit
+    return unit
+
+
+def rows(values, width, per_line):
+    for i in range(0, len(values), per_line):
+        yield "                " + ", ".join(f"0x{v:0{width}X}" for v in values[i:i + per_line]) + ","
+
+
+def main():
+    if unicodedata.unidata_version != UNICODE_VERSION:
+        sys.exit(f"uppercase_table.py: expected Unicode {UNICODE_VERSION}, "
+                 f"but this Python has {unicodedata.unidata_version}")
+
+    pages = []
+    page_index = [0] * 256
+    for high in range(256):
+        page = [uppercase((high << 8) | low) for low in range(256)]
+        if any(upper != (high << 8) | low for low, upper in enumerate(page)):
+            pages.append(page)
+            page_index[high] = len(pages)
+
+    print("#pragma once")
+    print()
+    print(f"// Generated by tools/uppercase_table.py from Unicode {UNICODE_VERSION}. Do not edit.")
+    print()
+    print("#include <cstdint>")
+    print()
+    print("namespace windows")
+    print("{")
+    print("    namespace case_insensitive")
+    print("    {")
+    print("        namespace detail")
+    print("        {")
+    print("            //! For each high byte of a code unit, 1 + its index into `uppercase_pages`, or 0 if no code unit in the page changes.")
+    print("            constexpr std::uint8_t uppercase_page_index[256] =")
+    print("            {")
+    for line in rows(page_index, 2, 16):
+        print(line)
+    print("            };")
+    print()
+    print("            //! Uppercase code unit for each low byte.")
+    print(f"            constexpr std::uint16_t uppercase_pages[{len(pages)}][256] =")
+    print("            {")
+    for page in pages:
+        print("                {")
+        for line in rows(page, 4, 16):
+            print("    " + line)
+        print("                },")
+    print("            };")
+    print("        }")
+    print("    }")
+    print("}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,12 @@
+// Replaces the global `operator new` and `operator delete` with the counting ones from `win64/allocation_audit.hpp`,
+// so that the runner can report how many allocations each benchmark makes per operation.
+
+#define WIN64_ALLOCATION_AUDIT
+#include "win64/allocation_audit.hpp"
+
+#include "benchmark.hpp"
+
+std::size_t bench::allocations()
+{
+    return static_cast<std::size_t>(windows::allocation_audit::detail::counts.allocations);
+}
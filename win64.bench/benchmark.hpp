@@ -0,0 +1,55 @@
+#pragma once
+
+// A minimal benchmark harness.
+//
+//     BENCHMARK(name)
+//     {
+//         for (std::size_t i = 0; i < iterations; ++i) { ... }
+//     }
+//
+// The body runs `iterations` operations; the runner in `main.cpp` picks the count and reports the time per operation.
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+    struct benchmark
+    {
+        const char* name;
+        void(*run)(std::size_t iterations);
+    };
+
+    inline std::vector<benchmark>& benchmarks()
+    {
+        static std::vector<benchmark> all;
+        return all;
+    }
+
+    inline bool register_benchmark(const char* name, void(*run)(std::size_t))
+    {
+        benchmarks().push_back(benchmark{ name, run });
+        return true;
+    }
+
+    //! Allocations made with `operator new` by the calling thread so far. Defined in `allocations.cpp`.
+    std::size_t allocations();
+
+    //! Prevent the compiler from optimizing away the computation of `value`.
+    template <typename T>
+    void do_not_optimize(T&& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static const void* volatile sink;
+        sink = &value;
+#endif
+    }
+}
+
+#define BENCHMARK(name) \
+    static void name(std::size_t iterations); \
+    static const bool name##_registered = ::bench::register_benchmark(#name, &name); \
+    static void name(std::size_t iterations)
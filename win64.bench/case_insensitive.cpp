@@ -0,0 +1,87 @@
+#include <cwctype>
+#include <string>
+#include <unordered_map>
+
+#include "win64/case_insensitive.hpp"
+
+#include "benchmark.hpp"
+
+using namespace windows;
+
+namespace
+{
+    const std::wstring key = L"Software\\Classes\\CLSID\\{6ED9970A-70E1-408C-AA5F-ADAA60BA8F17}\\InprocServer32";
+    const std::wstring key_other_case = L"SOFTWARE\\classes\\clsid\\{6ed9970a-70e1-408c-aa5f-adaa60ba8f17}\\inprocserver32";
+
+    //! What callers write without this header: uppercase every code unit before comparing.
+    bool equal_towupper(const std::wstring& a, const std::wstring& b)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            if (std::towupper(a[i]) != std::towupper(b[i]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::unordered_map<case_insensitive_path, int> make_keys()
+    {
+        std::unordered_map<case_insensitive_path, int> keys;
+        for (int i = 0; i < 1000; ++i)
+        {
+            keys.emplace(case_insensitive_path{ key + L"\\" + std::to_wstring(i) }, i);
+        }
+        return keys;
+    }
+
+    const auto keys = make_keys();
+    const case_insensitive_path lookup{ key_other_case + L"\\500" };
+}
+
+BENCHMARK(case_insensitive_equal)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(case_insensitive::equal(key, key_other_case));
+    }
+}
+
+BENCHMARK(case_insensitive_equal_towupper)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(equal_towupper(key, key_other_case));
+    }
+}
+
+BENCHMARK(case_insensitive_compare)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(case_insensitive::compare(key, key_other_case));
+    }
+}
+
+BENCHMARK(case_insensitive_hash)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(case_insensitive::hash_value(key));
+    }
+}
+
+BENCHMARK(case_insensitive_path_lookup)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(keys.find(lookup));
+    }
+}
\ No newline at end of file
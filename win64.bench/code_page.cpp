@@ -0,0 +1,66 @@
+#include <string>
+
+#include "win64/code_page.hpp"
+
+#include "benchmark.hpp"
+
+using namespace windows::locale;
+
+namespace
+{
+    //! 4 KiB of Russian text in code page 1251: mostly non-ASCII, with ASCII spaces and punctuation.
+    std::string long_text()
+    {
+        std::string text;
+        while (text.size() < 4096)
+        {
+            text += "\xD1\xFA\xE5\xF8\xFC \xE6\xE5 \xE5\xF9\xB8 \xFD\xF2\xE8\xF5 \xEC\xFF\xE3\xEA\xE8\xF5 \xE1\xF3\xEB\xEE\xEA. ";
+        }
+        return text;
+    }
+
+    const std::string long_cyrillic = long_text();
+    const std::string long_ascii(4096, 'a');
+    const std::u16string long_cyrillic_utf16 = code_page_to_utf16(code_page::windows_1251, long_cyrillic);
+    const std::string long_cyrillic_utf8 = code_page_to_utf8(code_page::windows_1251, long_cyrillic);
+}
+
+BENCHMARK(code_page_to_utf16_ascii_4k)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(code_page_to_utf16(code_page::windows_1251, long_ascii));
+    }
+}
+
+BENCHMARK(code_page_to_utf16_4k)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(code_page_to_utf16(code_page::windows_1251, long_cyrillic));
+    }
+}
+
+BENCHMARK(code_page_to_utf8_4k)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(code_page_to_utf8(code_page::windows_1251, long_cyrillic));
+    }
+}
+
+BENCHMARK(code_page_from_utf16_4k)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(utf16_to_code_page(code_page::windows_1251, long_cyrillic_utf16));
+    }
+}
+
+BENCHMARK(code_page_from_utf8_4k)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(utf8_to_code_page(code_page::windows_1251, long_cyrillic_utf8));
+    }
+}
\ No newline at end of file
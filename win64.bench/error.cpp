@@ -0,0 +1,41 @@
+// `system_error_message` is measured against the stand-in `FormatMessage` from `compat`
+// when built outside of Windows, so it measures the wrapper rather than the system message table.
+
+#include "win64/error.hpp"
+
+#include "benchmark.hpp"
+
+using namespace windows;
+
+BENCHMARK(error_hresult_to_wstring_known)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(hresult_to_wstring(E_ACCESSDENIED));
+    }
+}
+
+BENCHMARK(error_hresult_to_wstring_unknown)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(hresult_to_wstring(HRESULT_FROM_WIN32(ERROR_INVALID_PARAMETER)));
+    }
+}
+
+BENCHMARK(error_system_error_message)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(system_error_message(E_FAIL));
+    }
+}
+
+BENCHMARK(error_throw_if_failed_success)
+{
+    volatile long status = S_OK;
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        throw_if_failed(status);
+    }
+}
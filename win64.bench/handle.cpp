@@ -0,0 +1,73 @@
+#include <utility>
+
+#include "win64/deferred_close.hpp"
+#include "win64/handle.hpp"
+
+#include "benchmark.hpp"
+
+using namespace windows;
+
+namespace
+{
+    //! A handle that costs nothing to close, so that the benchmarks measure the queue.
+    struct free_handle_traits
+    {
+        using pointer = int;
+
+        static auto invalid() throw() -> pointer
+        {
+            return 0;
+        }
+
+        static auto close(pointer) throw() -> void
+        {
+        }
+    };
+}
+
+BENCHMARK(handle_move_construct)
+{
+    null_handle a{ ::CreateEvent(nullptr, TRUE, FALSE, nullptr) };
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        null_handle b{ std::move(a) };
+        a = null_handle{ b.release() };
+        bench::do_not_optimize(a);
+    }
+}
+
+BENCHMARK(handle_move_assign)
+{
+    null_handle a{ ::CreateEvent(nullptr, TRUE, FALSE, nullptr) };
+    null_handle b;
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        b = std::move(a);
+        a = std::move(b);
+        bench::do_not_optimize(a);
+    }
+}
+
+BENCHMARK(handle_swap)
+{
+    null_handle a{ ::CreateEvent(nullptr, TRUE, FALSE, nullptr) };
+    null_handle b{ ::CreateEvent(nullptr, TRUE, FALSE, nullptr) };
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        swap(a, b);
+        bench::do_not_optimize(a);
+    }
+}
+
+// The cost of queueing a handle and closing it on the background thread, which lands on the releasing thread
+// instead of the cost of the close itself.
+BENCHMARK(handle_release_deferred)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        unique_handle<deferred_close_traits<free_handle_traits>> h{ 1 };
+        bench::do_not_optimize(h);
+    }
+
+    deferred_closer<free_handle_traits>::flush();
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include <exception>
+#include <functional>
+
+#include "win64/function_ref.hpp"
+#include "win64/ktm.hpp"
+
+#include "benchmark.hpp"
+
+using namespace windows;
+
+// `ktm::transact` and `com::server::entry_point` used to take `const std::function&`. The `std_function` benchmarks
+// pass them one, which costs what passing a lambda used to: the conversion, which allocates for captures larger
+// than `std::function`'s small buffer, and an indirect call.
+
+namespace
+{
+    //! State for the lambdas, which capture it by reference: too much for `std::function`'s small buffer.
+    struct counters
+    {
+        int a = 0, b = 0, c = 0, d = 0, e = 0;
+    };
+
+    //! `com::server::entry_point` needs the Windows SDK, so this has the same shape: a call that converts exceptions to `HRESULT`s.
+    template <typename Function>
+    HRESULT guarded(Function&& function)
+    {
+        try
+        {
+            std::forward<Function>(function)();
+            return S_OK;
+        }
+        catch (const std::exception&)
+        {
+            return E_FAIL;
+        }
+        catch (...)
+        {
+            return E_UNEXPECTED;
+        }
+    }
+}
+
+BENCHMARK(ktm_transact)
+{
+    counters s;
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        ktm::transact([&a = s.a, &b = s.b, &c = s.c, &d = s.d, &e = s.e](const ktm::transaction&) { ++a; ++b; ++c; ++d; ++e; });
+    }
+    bench::do_not_optimize(s);
+}
+
+BENCHMARK(ktm_transact_function_ref)
+{
+    counters s;
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        auto action = [&a = s.a, &b = s.b, &c = s.c, &d = s.d, &e = s.e](const ktm::transaction&) { ++a; ++b; ++c; ++d; ++e; };
+        ktm::transact(function_ref<void(const ktm::transaction&)>{ action });
+    }
+    bench::do_not_optimize(s);
+}
+
+BENCHMARK(ktm_transact_std_function)
+{
+    counters s;
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        ktm::transact(std::function<void(const ktm::transaction&)>{ [&a = s.a, &b = s.b, &c = s.c, &d = s.d, &e = s.e](const ktm::transaction&) { ++a; ++b; ++c; ++d; ++e; } });
+    }
+    bench::do_not_optimize(s);
+}
+
+BENCHMARK(entry_point_call)
+{
+    counters s;
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(guarded([&a = s.a, &b = s.b, &c = s.c, &d = s.d, &e = s.e] { ++a; ++b; ++c; ++d; ++e; }));
+    }
+    bench::do_not_optimize(s);
+}
+
+BENCHMARK(entry_point_call_function_ref)
+{
+    counters s;
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        auto function = [&a = s.a, &b = s.b, &c = s.c, &d = s.d, &e = s.e] { ++a; ++b; ++c; ++d; ++e; };
+        bench::do_not_optimize(guarded(function_ref<void()>{ function }));
+    }
+    bench::do_not_optimize(s);
+}
+
+BENCHMARK(entry_point_call_std_function)
+{
+    counters s;
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(guarded(std::function<void()>{ [&a = s.a, &b = s.b, &c = s.c, &d = s.d, &e = s.e] { ++a; ++b; ++c; ++d; ++e; } }));
+    }
+    bench::do_not_optimize(s);
+}
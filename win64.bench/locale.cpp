@@ -0,0 +1,91 @@
+#include <string>
+
+#include "win64/locale.hpp"
+
+#include "benchmark.hpp"
+
+using namespace windows::locale;
+
+namespace
+{
+    const std::string short_ascii = "HKEY_LOCAL_MACHINE";
+    const std::wstring short_ascii_wide = L"HKEY_LOCAL_MACHINE";
+
+    //! 4 KiB of mixed one-, two- and three-byte UTF-8.
+    std::string long_text()
+    {
+        std::string text;
+        while (text.size() < 4096)
+        {
+            text += u8"Software\\Classes\\CLSID éè 中文 ";
+        }
+        return text;
+    }
+
+    const std::string long_multibyte = long_text();
+    const std::wstring long_wide = multibyte_to_wide(long_multibyte);
+}
+
+BENCHMARK(locale_multibyte_to_wide_short)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(multibyte_to_wide(short_ascii));
+    }
+}
+
+BENCHMARK(locale_multibyte_to_wide_4k)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(multibyte_to_wide(long_multibyte));
+    }
+}
+
+BENCHMARK(locale_wide_to_multibyte_short)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(wide_to_multibyte(short_ascii_wide));
+    }
+}
+
+BENCHMARK(locale_wide_to_multibyte_4k)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(wide_to_multibyte(long_wide));
+    }
+}
+
+BENCHMARK(locale_pmr_multibyte_to_wide_short)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(pmr::multibyte_to_wide(short_ascii));
+    }
+}
+
+BENCHMARK(locale_pmr_multibyte_to_wide_4k)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(pmr::multibyte_to_wide(long_multibyte));
+    }
+}
+
+BENCHMARK(locale_pmr_wide_to_multibyte_short)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(pmr::wide_to_multibyte(short_ascii_wide));
+    }
+}
+
+BENCHMARK(locale_pmr_wide_to_multibyte_4k)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(pmr::wide_to_multibyte(long_wide));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,228 @@
+// Runs the benchmarks registered with `BENCHMARK`.
+//
+//     win64.bench [--filter <text>] [--json <file>] [--baseline <file>] [--tolerance <ratio>] [--noise <ns>] [--min-time <ms>] [--samples <n>]
+//
+// Each benchmark is calibrated to run for at least `--min-time` milliseconds per sample,
+// and the fastest of `--samples` samples is reported along with the median and the allocations per operation.
+//
+// Every run also times a fixed reference workload, and each benchmark's fastest sample is divided by the reference's,
+// so that a baseline recorded on one machine can be checked on another.
+// With `--baseline`, the run fails if any benchmark's relative time is more than `--tolerance` above its baseline
+// (0.5 means 50% slower) and its fastest sample is more than `--noise` nanoseconds above the baseline scaled to this
+// machine, since operations that take a nanosecond or two move by more than that with code alignment alone.
+// Allocations are reported, but not compared with the baseline.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "benchmark.hpp"
+
+namespace
+{
+    struct options
+    {
+        std::string filter;
+        std::string json;
+        std::string baseline;
+        double tolerance = 0.5;
+        double noise_ns = 2;
+        double min_time_ms = 20;
+        int samples = 5;
+    };
+
+    struct result
+    {
+        std::string name;
+        std::size_t iterations;
+        double ns_per_op;
+        double min_ns_per_op;
+        double allocations_per_op;
+        double relative; //!< `min_ns_per_op` divided by the reference's
+    };
+
+    //! The reference workload: FNV-1a over 1 KiB, a chain of dependent multiplies and loads that no compiler vectorizes.
+    void reference(std::size_t iterations)
+    {
+        static unsigned char data[1024];
+        for (std::size_t i = 0; i < iterations; ++i)
+        {
+            std::uint64_t hash = 14695981039346656037ull;
+            for (const auto byte : data)
+            {
+                hash = (hash ^ byte) * 1099511628211ull;
+            }
+            bench::do_not_optimize(hash);
+            bench::do_not_optimize(data);
+        }
+    }
+
+    double time_ns(const bench::benchmark& b, std::size_t iterations)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        b.run(iterations);
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    result measure(const bench::benchmark& b, const options& o)
+    {
+        std::size_t iterations = 1;
+        b.run(iterations);
+
+        while (time_ns(b, iterations) < o.min_time_ms * 1e6 && iterations < (std::size_t{ 1 } << 40))
+        {
+            iterations *= 2;
+        }
+
+        std::vector<double> samples;
+        const auto allocations = bench::allocations();
+        for (int i = 0; i < o.samples; ++i)
+        {
+            samples.push_back(time_ns(b, iterations) / iterations);
+        }
+
+        const auto allocations_per_op = static_cast<double>(bench::allocations() - allocations) / (static_cast<double>(iterations) * o.samples);
+
+        std::sort(samples.begin(), samples.end());
+        return result{ b.name, iterations, samples[samples.size() / 2], samples.front(), allocations_per_op, 0 };
+    }
+
+    //! Read the `relative` time of each benchmark from a file written by `write_json`.
+    std::map<std::string, double> read_baseline(const std::string& path)
+    {
+        std::ifstream input{ path };
+        if (!input)
+        {
+            std::fprintf(stderr, "cannot open baseline %s\n", path.c_str());
+            std::exit(2);
+        }
+
+        const std::regex entry{ "\"name\": \"([^\"]+)\".*\"relative\": ([0-9.eE+-]+)" };
+        std::map<std::string, double> baseline;
+        std::string line;
+        while (std::getline(input, line))
+        {
+            std::smatch match;
+            if (std::regex_search(line, match, entry))
+            {
+                baseline[match[1]] = std::stod(match[2]);
+            }
+        }
+
+        return baseline;
+    }
+
+    void write_json(const std::string& path, const result& reference, const std::vector<result>& results)
+    {
+        std::ofstream output{ path };
+        output << "{\n    \"reference_ns_per_op\": " << reference.min_ns_per_op << ",\n    \"benchmarks\": [\n";
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            const auto& r = results[i];
+            output << "        { \"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+                << ", \"ns_per_op\": " << r.ns_per_op << ", \"min_ns_per_op\": " << r.min_ns_per_op << ", \"allocations_per_op\": " << r.allocations_per_op << ", \"relative\": " << r.relative << " }"
+                << (i + 1 == results.size() ? "\n" : ",\n");
+        }
+        output << "    ]\n}\n";
+    }
+
+    options parse(int argc, char** argv)
+    {
+        options o;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            const auto value = [&] { return i + 1 < argc ? std::string{ argv[++i] } : std::string{}; };
+
+            if (arg == "--filter") o.filter = value();
+            else if (arg == "--json") o.json = value();
+            else if (arg == "--baseline") o.baseline = value();
+            else if (arg == "--tolerance") o.tolerance = std::stod(value());
+            else if (arg == "--noise") o.noise_ns = std::stod(value());
+            else if (arg == "--min-time") o.min_time_ms = std::stod(value());
+            else if (arg == "--samples") o.samples = std::max(1, std::stoi(value()));
+            else
+            {
+                std::fprintf(stderr, "usage: %s [--filter <text>] [--json <file>] [--baseline <file>] [--tolerance <ratio>] [--noise <ns>] [--min-time <ms>] [--samples <n>]\n", argv[0]);
+                std::exit(2);
+            }
+        }
+        return o;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const auto o = parse(argc, argv);
+    const auto baseline = o.baseline.empty() ? std::map<std::string, double>{} : read_baseline(o.baseline);
+
+    auto all = bench::benchmarks();
+    std::sort(all.begin(), all.end(), [](const bench::benchmark& a, const bench::benchmark& b)
+    {
+        return std::string{ a.name } < b.name;
+    });
+
+    // Twice as many samples as the benchmarks, since every relative time depends on it.
+    auto reference_options = o;
+    reference_options.samples *= 2;
+    const auto reference_result = measure(bench::benchmark{ "reference", &reference }, reference_options);
+    const auto reference_ns = reference_result.min_ns_per_op;
+
+    std::printf("%-44s %12s %12s %10s %10s %12s\n", "benchmark", "median", "fastest", "allocs/op", "relative", "baseline");
+    std::printf("%-44s %9.2f ns %9.2f ns\n", "reference", reference_result.ns_per_op, reference_ns);
+
+    std::vector<result> results;
+    int regressions = 0;
+
+    for (const auto& b : all)
+    {
+        if (std::string{ b.name }.find(o.filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        auto r = measure(b, o);
+        r.relative = r.min_ns_per_op / reference_ns;
+        results.push_back(r);
+
+        std::printf("%-44s %9.2f ns %9.2f ns %10.2f %10.4f", r.name.c_str(), r.ns_per_op, r.min_ns_per_op, r.allocations_per_op, r.relative);
+
+        const auto expected = baseline.find(r.name);
+        if (expected == baseline.end())
+        {
+            std::printf(o.baseline.empty() ? "\n" : "          new\n");
+        }
+        else
+        {
+            // The baseline in this machine's nanoseconds.
+            const auto expected_ns = expected->second * reference_ns;
+            if (r.relative > expected->second * (1 + o.tolerance) && r.min_ns_per_op > expected_ns + o.noise_ns)
+            {
+                ++regressions;
+                std::printf(" %9.2f ns  REGRESSION (%.0f%% slower)\n", expected_ns, (r.relative / expected->second - 1) * 100);
+            }
+            else
+            {
+                std::printf(" %9.2f ns\n", expected_ns);
+            }
+        }
+    }
+
+    if (!o.json.empty())
+    {
+        write_json(o.json, reference_result, results);
+    }
+
+    if (regressions != 0)
+    {
+        std::printf("%d benchmark(s) regressed by more than %.0f%%\n", regressions, o.tolerance * 100);
+        return 1;
+    }
+}
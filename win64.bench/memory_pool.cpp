@@ -0,0 +1,102 @@
+// Compares `memory_pool` against the global allocator for the allocation pattern of COM objects:
+// many small reference-counted objects, each destroyed by its final `Release`.
+// The default allocation path stands in for `Microsoft::WRL::Make`, which allocates with the global `operator new`.
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "win64/memory_pool.hpp"
+
+#include "benchmark.hpp"
+
+using namespace windows::memory;
+
+namespace
+{
+    struct object_base
+    {
+        virtual ~object_base() = default;
+
+        void release()
+        {
+            if (--references == 0)
+            {
+                delete this;
+            }
+        }
+
+        std::atomic<unsigned long> references{ 1 };
+    };
+
+    struct default_object : public object_base
+    {
+        char payload[40];
+    };
+
+    struct pooled_object : public object_base, public pooled_allocation<pooled_object>
+    {
+        char payload[40];
+    };
+
+    constexpr std::size_t live_objects = 1000;
+
+    //! Keep `live_objects` objects alive, repeatedly releasing the oldest and replacing it.
+    template <typename Object>
+    void churn(std::size_t iterations)
+    {
+        std::vector<object_base*> objects(live_objects);
+        for (auto& object : objects)
+        {
+            object = new Object{};
+        }
+
+        for (std::size_t i = 0; i < iterations; ++i)
+        {
+            auto& object = objects[i % live_objects];
+            object->release();
+            object = new Object{};
+        }
+
+        for (const auto object : objects)
+        {
+            object->release();
+        }
+    }
+
+    //! `churn` on four threads at once; reports the time per operation on each thread.
+    template <typename Object>
+    void churn_threads(std::size_t iterations)
+    {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i)
+        {
+            threads.emplace_back([iterations] { churn<Object>(iterations); });
+        }
+
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+    }
+}
+
+BENCHMARK(memory_pool_churn_default)
+{
+    churn<default_object>(iterations);
+}
+
+BENCHMARK(memory_pool_churn_pooled)
+{
+    churn<pooled_object>(iterations);
+}
+
+BENCHMARK(memory_pool_churn_4_threads_default)
+{
+    churn_threads<default_object>(iterations);
+}
+
+BENCHMARK(memory_pool_churn_4_threads_pooled)
+{
+    churn_threads<pooled_object>(iterations);
+}
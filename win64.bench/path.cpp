@@ -0,0 +1,29 @@
+#include <string>
+
+#include "win64/path.hpp"
+
+#include "benchmark.hpp"
+
+using namespace windows;
+
+namespace
+{
+    const path root{ L"Software\\Classes\\CLSID" };
+    const std::wstring clsid = L"{6ED9970A-70E1-408C-AA5F-ADAA60BA8F17}";
+}
+
+BENCHMARK(path_join)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(root / clsid);
+    }
+}
+
+BENCHMARK(path_join_chain_3)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(root / clsid / L"InprocServer32" / L"ThreadingModel");
+    }
+}
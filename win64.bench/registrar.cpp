@@ -0,0 +1,112 @@
+#include <string>
+#include <vector>
+
+#include "win64/arena.hpp"
+#include "win64/locale.hpp"
+#include "win64/server_registrar.hpp"
+
+#include "benchmark.hpp"
+
+using namespace windows;
+using namespace windows::com::server;
+
+namespace
+{
+    //! A COM class as it appears in a UTF-8 manifest.
+    struct manifest_class
+    {
+        std::string clsid;
+        std::string name;
+        std::string server;
+    };
+
+    //! A manifest of 100 classes.
+    std::vector<manifest_class> make_manifest()
+    {
+        std::vector<manifest_class> manifest;
+        for (int i = 0; i < 100; ++i)
+        {
+            const auto n = std::to_string(10000 + i);
+            manifest.push_back({
+                "{6ED9970A-70E1-408C-AA5F-ADAA600" + n + "}",
+                u8"Contoso Widget Ünïcode Édition " + n,
+                u8"C:\\Program Files\\Contoso\\Widgets\\widgets-" + n + ".dll" });
+        }
+        return manifest;
+    }
+
+    const std::vector<manifest_class> manifest = make_manifest();
+    const path classes{ L"Software\\win64.bench\\CLSID" };
+
+    server_registrar build_std()
+    {
+        std::vector<registry_entry> entries;
+        entries.reserve(manifest.size() * 3);
+
+        for (const auto& c : manifest)
+        {
+            const auto key = classes / locale::multibyte_to_wide(c.clsid);
+            const auto server = key / L"InprocServer32";
+
+            entries.push_back({ key, true, std::nullopt, locale::multibyte_to_wide(c.name) });
+            entries.push_back({ server, false, std::nullopt, locale::multibyte_to_wide(c.server) });
+            entries.push_back({ server, false, std::wstring{ L"ThreadingModel" }, std::wstring{ L"Both" } });
+        }
+
+        return server_registrar{ std::move(entries), registry::hive::current_user };
+    }
+
+    com::server::pmr::server_registrar build_pmr(std::pmr::memory_resource* arena)
+    {
+        const windows::pmr::path root{ classes.str, arena };
+
+        com::server::pmr::server_registrar::container_type entries{ arena };
+        entries.reserve(manifest.size() * 3);
+
+        for (const auto& c : manifest)
+        {
+            const auto key = root / locale::pmr::multibyte_to_wide(c.clsid, arena);
+            const auto server = key / L"InprocServer32";
+
+            entries.push_back({ key, true, std::nullopt, locale::pmr::multibyte_to_wide(c.name, arena) });
+            entries.push_back({ server, false, std::nullopt, locale::pmr::multibyte_to_wide(c.server, arena) });
+            entries.push_back({ server, false, std::pmr::wstring{ L"ThreadingModel", arena }, std::pmr::wstring{ L"Both", arena } });
+        }
+
+        return com::server::pmr::server_registrar{ std::move(entries), registry::hive::current_user };
+    }
+}
+
+BENCHMARK(registrar_manifest_build_std)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(build_std());
+    }
+}
+
+BENCHMARK(registrar_manifest_build_pmr)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        memory::scoped_arena<64 * 1024> arena;
+        bench::do_not_optimize(build_pmr(arena));
+    }
+}
+
+BENCHMARK(registrar_manifest_register_std)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        build_std().register_entries();
+    }
+}
+
+BENCHMARK(registrar_manifest_register_pmr)
+{
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        memory::scoped_arena<64 * 1024> arena;
+        build_pmr(arena).register_entries();
+    }
+}
@@ -0,0 +1,80 @@
+// Outside of Windows, the kernel objects are the stand-ins from `compat`,
+// so these measure the wrappers plus a mutex rather than real kernel transitions.
+
+#include <vector>
+
+#include "win64/handle.hpp"
+#include "win64/synchronization.hpp"
+
+#include "benchmark.hpp"
+
+using namespace windows;
+using namespace windows::synchronization;
+
+namespace
+{
+    std::vector<null_handle> create_events(std::size_t count, bool signaled)
+    {
+        std::vector<null_handle> events;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            events.emplace_back(::CreateEvent(nullptr, TRUE, signaled, nullptr));
+        }
+        return events;
+    }
+
+    std::vector<HANDLE> handles_of(const std::vector<null_handle>& events)
+    {
+        std::vector<HANDLE> handles;
+        for (const auto& e : events)
+        {
+            handles.push_back(e.get());
+        }
+        return handles;
+    }
+}
+
+BENCHMARK(synchronization_wait_signaled)
+{
+    const auto events = create_events(1, true);
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        wait(events[0].get());
+    }
+}
+
+BENCHMARK(synchronization_wait_for_all_4_signaled)
+{
+    const auto events = create_events(4, true);
+    const auto handles = handles_of(events);
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        wait_for_all(handles);
+    }
+}
+
+BENCHMARK(synchronization_wait_for_any_4_last_signaled)
+{
+    auto events = create_events(3, false);
+    events.emplace_back(::CreateEvent(nullptr, TRUE, TRUE, nullptr));
+    const auto handles = handles_of(events);
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        bench::do_not_optimize(wait_for_any(handles));
+    }
+}
+
+BENCHMARK(synchronization_wait_timeout_zero)
+{
+    const auto events = create_events(1, false);
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        try
+        {
+            wait(events[0].get(), 0);
+        }
+        catch (const timeout_wexception&)
+        {
+        }
+    }
+}
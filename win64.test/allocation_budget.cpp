@@ -0,0 +1,330 @@
+#include <CppUnitTest.h>
+
+// The replacement global allocator is compiled into this translation unit, so this file is built as its own
+// test executable; see `CMakeLists.txt`.
+#define WIN64_ALLOCATION_AUDIT
+#include "win64/allocation_audit.hpp"
+
+#include "win64/arena.hpp"
+#include "win64/case_insensitive.hpp"
+#include "win64/class_object_cache.hpp"
+#include "win64/code_page.hpp"
+#include "win64/deferred_close.hpp"
+#include "win64/error.hpp"
+#include "win64/function_ref.hpp"
+#include "win64/handle.hpp"
+#include "win64/ktm.hpp"
+#include "win64/locale.hpp"
+#include "win64/memory_pool.hpp"
+#include "win64/path.hpp"
+#include "win64/registry.hpp"
+#include "win64/server_registrar.hpp"
+#include "win64/synchronization.hpp"
+#include "win64/telemetry.hpp"
+#include "win64/trace.hpp"
+
+#include <cwchar>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace windows;
+using namespace windows::allocation_audit;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Each wrapper gets a budget of allocations per call, which is zero on every success path that does not return a string.
+// Functions that return a string or a vector may allocate it, once. The registry and KTM stand-ins in `compat` allocate
+// themselves, so those wrappers are held to the allocations of the calls they wrap.
+
+namespace
+{
+    //! Assert that `function` makes exactly `budget` allocations.
+    template <typename Function>
+    void assert_allocations(unsigned long long budget, Function&& function, const wchar_t* message = nullptr)
+    {
+        Assert::AreEqual(budget, count_allocations(function).allocations, message);
+    }
+
+    struct fake_handle_traits
+    {
+        using pointer = int;
+
+        static auto invalid() throw() -> pointer
+        {
+            return 0;
+        }
+
+        static auto close(pointer) throw() -> void
+        {
+        }
+    };
+
+    struct fake_activation_traits
+    {
+        using key_type = int;
+        using pointer = shared_ptr<int>;
+
+        static pointer get_class_object(const key_type& key, unsigned long)
+        {
+            return make_shared<int>(key);
+        }
+    };
+
+    const wstring long_name = L"Software\\Classes\\CLSID\\{6ED9970A-70E1-408C-AA5F-ADAA60BA8F17}";
+}
+
+TEST_CLASS(allocation_audit_test)
+{
+public:
+
+    TEST_METHOD(counts_allocations_and_bytes)
+    {
+        Assert::IsTrue(enabled());
+
+        const scoped_allocation_counter outer;
+        static long long* volatile block;
+        auto counts = count_allocations([] { block = new long long[4]; delete[] block; });
+
+        Assert::AreEqual(1ull, counts.allocations);
+        Assert::AreEqual(1ull, counts.deallocations);
+        Assert::AreEqual(4 * sizeof(long long), static_cast<size_t>(counts.bytes));
+
+        // Nested counters only see their own allocations.
+        unique_ptr<int> kept{ new int{ 0 } };
+        Assert::AreEqual(2ull, outer.allocations());
+        Assert::AreEqual(1ull, outer.counts().deallocations);
+    }
+};
+
+TEST_CLASS(allocation_budget_test)
+{
+public:
+
+    TEST_METHOD(error_budgets)
+    {
+        // Warm up the calling thread's telemetry, which registers itself on first use.
+        telemetry::record_failure(telemetry::failure_source::exception, E_FAIL);
+
+        assert_allocations(0, [] { throw_if_failed(S_OK); }, L"throw_if_failed(HRESULT)");
+        assert_allocations(0, [] { throw_if_failed(TRUE); }, L"throw_if_failed(BOOL)");
+        assert_allocations(0, [] { telemetry::record_failure(telemetry::failure_source::exception, E_FAIL); }, L"record_failure");
+        assert_allocations(1, [] { hresult_to_wstring(E_NOINTERFACE); }, L"hresult_to_wstring");
+        assert_allocations(1, [] { hresult_to_wstring(0x80070005L); }, L"hresult_to_wstring, unnamed");
+        assert_allocations(1, [] { system_error_message(E_FAIL); }, L"system_error_message");
+        assert_allocations(1, [] { win32_wexception{ E_FAIL }; }, L"win32_wexception");
+        assert_allocations(1, [] { win32_wexception{ 0x80070005L }; }, L"win32_wexception, unnamed");
+    }
+
+    TEST_METHOD(telemetry_budgets)
+    {
+        telemetry::record_failure(telemetry::failure_source::throw_if_failed, E_FAIL);
+        telemetry::record_failure(telemetry::failure_source::timeout, E_FAIL);
+
+        assert_allocations(1, [] { telemetry::snapshot(); }, L"telemetry::snapshot");
+    }
+
+    TEST_METHOD(synchronization_budgets)
+    {
+        // Manual-reset events that are already signaled, so that every wait succeeds at once.
+        const vector<HANDLE> events{ ::CreateEvent(nullptr, TRUE, TRUE, nullptr), ::CreateEvent(nullptr, TRUE, TRUE, nullptr) };
+
+        assert_allocations(0, [&] { synchronization::wait(events[0]); }, L"wait");
+        assert_allocations(0, [&] { synchronization::wait(events[0], 0); }, L"wait with a timeout");
+        assert_allocations(0, [&] { synchronization::wait_for_all(events); }, L"wait_for_all");
+        assert_allocations(0, [&] { synchronization::wait_for_any(events); }, L"wait_for_any");
+
+        for (const auto event : events)
+        {
+            ::CloseHandle(event);
+        }
+    }
+
+    TEST_METHOD(path_budgets)
+    {
+        const path root{ long_name };
+        assert_allocations(1, [&] { root / L"InprocServer32"; }, L"path::operator/");
+        assert_allocations(2, [&] { root / L"InprocServer32" / L"ThreadingModel"; }, L"path::operator/, chained");
+
+        memory::scoped_arena<> arena{ std::pmr::null_memory_resource() };
+        const windows::pmr::path pmr_root{ long_name, arena.allocator<wchar_t>() };
+        assert_allocations(0, [&] { pmr_root / L"InprocServer32" / L"ThreadingModel"; }, L"pmr::path::operator/");
+        assert_allocations(0, [&] { windows::pmr::path copy{ pmr_root }; }, L"pmr::path copy");
+    }
+
+    TEST_METHOD(locale_budgets)
+    {
+        const string multibyte = u8"Software\\Classes\\Ünïcode \xF0\x9F\x98\x80";
+        const auto wide = locale::multibyte_to_wide(multibyte);
+
+        assert_allocations(1, [&] { locale::multibyte_to_wide(multibyte); }, L"multibyte_to_wide");
+        assert_allocations(1, [&] { locale::wide_to_multibyte(wide); }, L"wide_to_multibyte");
+
+        memory::scoped_arena<> arena{ std::pmr::null_memory_resource() };
+        assert_allocations(0, [&] { locale::pmr::multibyte_to_wide(multibyte, arena); }, L"pmr::multibyte_to_wide");
+        assert_allocations(0, [&] { locale::pmr::wide_to_multibyte(wide, arena); }, L"pmr::wide_to_multibyte");
+    }
+
+    TEST_METHOD(code_page_budgets)
+    {
+        const string bytes = "Caf\xE9 cr\xE8" "me br\xFBl\xE9" "e, 20\x80";
+        wstring output;
+        output.reserve(64);
+
+        assert_allocations(0, [&] { output.clear(); locale::code_page_to_wide(locale::code_page::windows_1252, bytes, output); }, L"code_page_to_wide into a reserved string");
+        assert_allocations(1, [&] { locale::code_page_to_wide(locale::code_page::windows_1252, bytes); }, L"code_page_to_wide");
+        assert_allocations(1, [&] { locale::wide_to_code_page(locale::code_page::windows_1252, output); }, L"wide_to_code_page");
+    }
+
+    TEST_METHOD(case_insensitive_budgets)
+    {
+        const wstring upper = L"SOFTWARE\\CLASSES\\CLSID\\{6ED9970A-70E1-408C-AA5F-ADAA60BA8F17}";
+
+        assert_allocations(0, [&] { case_insensitive::equal(long_name, upper); }, L"equal");
+        assert_allocations(0, [&] { case_insensitive::compare(long_name, upper); }, L"compare");
+        assert_allocations(0, [&] { case_insensitive::hash_value(long_name); }, L"hash_value");
+        assert_allocations(1, [&] { case_insensitive_path{ long_name }; }, L"case_insensitive_path");
+    }
+
+    TEST_METHOD(handle_budgets)
+    {
+        using handle = unique_handle<fake_handle_traits>;
+
+        assert_allocations(0, []
+        {
+            handle a{ 1 };
+            handle b{ std::move(a) };
+            b.reset(2);
+        }, L"unique_handle");
+    }
+
+    TEST_METHOD(memory_pool_budgets)
+    {
+        // The first allocation of a size class refills the thread's free list.
+        memory::memory_pool::deallocate(memory::memory_pool::allocate(48), 48);
+
+        assert_allocations(0, []
+        {
+            memory::memory_pool::deallocate(memory::memory_pool::allocate(48), 48);
+        }, L"memory_pool");
+    }
+
+    TEST_METHOD(deferred_close_budgets)
+    {
+        using closer = deferred_closer<fake_handle_traits>;
+
+        // Start the background thread and fill the pool's free list.
+        closer::enqueue(1);
+        closer::flush();
+
+        assert_allocations(0, [] { closer::enqueue(2); }, L"deferred_closer::enqueue");
+        closer::flush();
+    }
+
+    TEST_METHOD(class_object_cache_budgets)
+    {
+        using cache = com::class_object_cache<fake_activation_traits>;
+        cache::get(1, 0);
+
+        assert_allocations(0, [] { cache::get(1, 0); }, L"class_object_cache::get, cached");
+        cache::flush();
+    }
+
+    TEST_METHOD(trace_budgets)
+    {
+        assert_allocations(0, [] { WIN64_TRACE_SPAN(trace::event_id::user, 0); }, L"WIN64_TRACE_SPAN without a session");
+        assert_allocations(0, [] { WIN64_TRACE_EVENT(trace::event_id::user, 0); }, L"WIN64_TRACE_EVENT without a session");
+    }
+
+    TEST_METHOD(registry_budgets)
+    {
+        HKEY key = nullptr;
+        throw_if_failed(::RegCreateKeyTransactedW(HKEY_CURRENT_USER, L"Software\\win64.test\\allocations", 0, nullptr, 0, KEY_WRITE, nullptr, &key, nullptr, nullptr, nullptr));
+        const registry::unique_key owner{ key };
+
+        const wstring data = long_name;
+        const auto set_value = [&]
+        {
+            throw_if_failed(::RegSetValueExW(key, nullptr, 0, REG_SZ, reinterpret_cast<const BYTE*>(data.c_str()), static_cast<DWORD>((data.size() + 1) * sizeof(wchar_t))));
+        };
+
+        // The first call creates the value; the others replace it.
+        set_value();
+        const auto raw = count_allocations(set_value);
+
+        const auto wrapped = count_allocations([&] { registry::set_value_string(key, nullopt, data); });
+        Assert::AreEqual(raw.allocations, wrapped.allocations, L"set_value_string");
+    }
+
+    TEST_METHOD(server_registrar_budgets)
+    {
+        memory::scoped_arena<> arena{ std::pmr::null_memory_resource() };
+        const auto allocator = arena.allocator<wchar_t>();
+
+        const windows::pmr::path key{ L"Software\\win64.test\\allocations\\registrar", allocator };
+        const auto server = key / L"InprocServer32";
+
+        com::server::pmr::server_registrar::container_type entries{ arena.allocator<com::server::pmr::registry_entry>() };
+        entries.reserve(2);
+        entries.push_back({ key, true, nullopt, std::pmr::wstring{ L"win64.test class", allocator } });
+        entries.push_back({ server, false, std::pmr::wstring{ L"ThreadingModel", allocator }, std::pmr::wstring{ L"Both", allocator } });
+
+        optional<com::server::pmr::server_registrar> registrar;
+        assert_allocations(0, [&] { registrar.emplace(std::move(entries), registry::hive::current_user); }, L"pmr::server_registrar");
+
+        // The same registry and KTM calls that registration makes, through the wrappers.
+        const auto set_value = [](HKEY k, const wchar_t* name, const wchar_t* data)
+        {
+            registry::set_value_string(k, name, data, wcslen(data));
+        };
+        const auto register_by_hand = [&]
+        {
+            ktm::transact([&](const ktm::transaction& t)
+            {
+                registry::delete_subtree(registry::hive::current_user, key.c_str(), t);
+                set_value(registry::create_key(registry::hive::current_user, key.c_str(), KEY_WRITE, t).get(), nullptr, L"win64.test class");
+                set_value(registry::create_key(registry::hive::current_user, server.c_str(), KEY_WRITE, t).get(), L"ThreadingModel", L"Both");
+            });
+        };
+        const auto unregister_by_hand = [&]
+        {
+            ktm::transact([&](const ktm::transaction& t) { registry::delete_subtree(registry::hive::current_user, key.c_str(), t); });
+        };
+
+        // The first registration creates the keys; the others replace them.
+        registrar->register_entries();
+
+        const auto raw = count_allocations(register_by_hand);
+        const auto wrapped = count_allocations([&] { registrar->register_entries(); });
+        Assert::AreEqual(raw.allocations, wrapped.allocations, L"server_registrar::register_entries");
+
+        const auto raw_unregister = count_allocations(unregister_by_hand);
+        registrar->register_entries();
+        const auto wrapped_unregister = count_allocations([&] { registrar->unregister_entries(); });
+        Assert::AreEqual(raw_unregister.allocations, wrapped_unregister.allocations, L"server_registrar::unregister_entries");
+    }
+
+    TEST_METHOD(ktm_budgets)
+    {
+        const auto raw = count_allocations([]
+        {
+            const ktm::transaction t{};
+            t.commit();
+        });
+
+        // Captures too much for `std::function` to store without allocating.
+        int a = 0, b = 0, c = 0, d = 0, e = 0;
+        const auto action = [&a, &b, &c, &d, &e](const ktm::transaction&) { ++a; ++b; ++c; ++d; ++e; };
+
+        const auto wrapped = count_allocations([&] { ktm::transact(action); });
+        Assert::AreEqual(raw.allocations, wrapped.allocations, L"transact");
+
+        const auto referenced = count_allocations([&] { ktm::transact(function_ref<void(const ktm::transaction&)>{ action }); });
+        Assert::AreEqual(raw.allocations, referenced.allocations, L"transact with function_ref");
+
+        const auto erased = count_allocations([&] { ktm::transact(std::function<void(const ktm::transaction&)>{ action }); });
+        Assert::AreEqual(raw.allocations + 1, erased.allocations, L"transact with std::function");
+    }
+};
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include <CppUnitTest.h>
+
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "win64/arena.hpp"
+#include "win64/locale.hpp"
+#include "win64/path.hpp"
+
+using namespace std;
+using namespace windows;
+using namespace windows::memory;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+    //! Counts the allocations that reach it and forwards them to the default resource.
+    class counting_resource : public std::pmr::memory_resource
+    {
+    public:
+        int allocations = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            ++allocations;
+            return std::pmr::get_default_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override
+        {
+            std::pmr::get_default_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+}
+
+TEST_CLASS(arena_test)
+{
+public:
+
+    TEST_METHOD(arena_inline_buffer_test)
+    {
+        // With nowhere to go upstream, anything that does not fit in the inline buffer throws.
+        scoped_arena<1024> arena{ std::pmr::null_memory_resource() };
+
+        std::pmr::vector<int> small{ arena.allocator<int>() };
+        small.reserve(100);
+
+        Assert::ExpectException<std::bad_alloc>([&] { std::pmr::vector<int> large(1000, 0, arena.allocator<int>()); });
+    }
+
+    TEST_METHOD(arena_upstream_test)
+    {
+        counting_resource upstream;
+
+        {
+            scoped_arena<256> arena{ &upstream };
+            std::pmr::vector<std::pmr::wstring> strings{ arena.allocator<std::pmr::wstring>() };
+            for (int i = 0; i < 100; ++i)
+            {
+                strings.emplace_back(L"a string too long for the small string buffer");
+            }
+
+            // The arena takes growing blocks, so far fewer than one per string.
+            Assert::IsTrue(upstream.allocations > 0);
+            Assert::IsTrue(upstream.allocations < 20);
+        }
+
+        scoped_arena<256> arena{ &upstream };
+        const auto before = upstream.allocations;
+        std::pmr::wstring s(100, L'x', arena.allocator<wchar_t>());
+        arena.release();
+
+        // `release` gives back the blocks and starts over from the inline buffer.
+        std::pmr::wstring t(10, L'x', arena.allocator<wchar_t>());
+        Assert::AreEqual(before + 1, upstream.allocations);
+    }
+
+    TEST_METHOD(pmr_path_test)
+    {
+        scoped_arena<> arena{ std::pmr::null_memory_resource() };
+
+        const windows::pmr::path root{ L"Software\\Classes\\CLSID", arena.allocator<wchar_t>() };
+        const auto joined = root / L"{6ED9970A-70E1-408C-AA5F-ADAA60BA8F17}" / L"InprocServer32";
+
+        Assert::IsTrue(joined.get_allocator().resource() == arena.get());
+        Assert::AreEqual(wstring{ L"Software\\Classes\\CLSID\\{6ED9970A-70E1-408C-AA5F-ADAA60BA8F17}\\InprocServer32" }, wstring{ joined.c_str() });
+        Assert::AreEqual((path{ L"Software\\Classes\\CLSID" } / L"{6ED9970A-70E1-408C-AA5F-ADAA60BA8F17}" / L"InprocServer32").str, wstring{ joined.c_str() });
+    }
+
+    TEST_METHOD(pmr_encoding_conversion_test)
+    {
+        scoped_arena<> arena{ std::pmr::null_memory_resource() };
+
+        const vector<string> inputs{
+            "",
+            "Hello!",
+            "Caf\xC3\xA9 \xE2\x82\xAC",
+            "\xF0\x9F\x98\x80 outside the BMP",
+        };
+
+        for (const auto& multibyte : inputs)
+        {
+            const auto wide = locale::pmr::multibyte_to_wide(multibyte, arena);
+            Assert::AreEqual(locale::multibyte_to_wide(multibyte), wstring{ wide.begin(), wide.end() });
+            Assert::IsTrue(wide.get_allocator().resource() == arena.get());
+
+            const auto round_trip = locale::pmr::wide_to_multibyte(wide, arena);
+            Assert::AreEqual(multibyte, string{ round_trip.begin(), round_trip.end() });
+        }
+    }
+
+    TEST_METHOD(pmr_encoding_conversion_invalid_test)
+    {
+        scoped_arena<> arena;
+
+        Assert::ExpectException<std::range_error>([&] { locale::pmr::multibyte_to_wide("\xC3", arena); });
+        Assert::ExpectException<std::range_error>([&] { locale::pmr::multibyte_to_wide("\xC0\x80", arena); });
+        Assert::ExpectException<std::range_error>([&] { locale::pmr::multibyte_to_wide("\xED\xA0\x80", arena); });
+
+        const wchar_t unpaired[] = { L'a', static_cast<wchar_t>(0xD800), L'b', L'\0' };
+        Assert::ExpectException<std::range_error>([&] { locale::pmr::wide_to_multibyte(unpaired, arena); });
+    }
+};
\ No newline at end of file
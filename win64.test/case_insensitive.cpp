@@ -0,0 +1,183 @@
+#include <CppUnitTest.h>
+
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#include "win64/case_insensitive.hpp"
+
+using namespace std;
+using namespace windows;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+    //! Reference comparison: uppercase one code unit at a time.
+    template <typename String>
+    int compare_reference(const String& a, const String& b)
+    {
+        for (size_t i = 0; i < a.size() && i < b.size(); ++i)
+        {
+            const auto x = static_cast<unsigned long>(case_insensitive::to_upper(a[i]));
+            const auto y = static_cast<unsigned long>(case_insensitive::to_upper(b[i]));
+            if (x != y)
+            {
+                return x < y ? -1 : 1;
+            }
+        }
+
+        return a.size() == b.size() ? 0 : (a.size() < b.size() ? -1 : 1);
+    }
+
+    int sign(int n)
+    {
+        return (n > 0) - (n < 0);
+    }
+
+    //! Pairs of random strings that are often equal up to case, so that every branch of the kernels runs.
+    template <typename String>
+    void for_each_random_pair(void(*check)(const String&, const String&))
+    {
+        using char_type = typename String::value_type;
+        const char_type alphabet[] = { 'a', 'B', 'z', '_', '@', '[', '`', '{', 0xE9, 0xC9, 0x44F, 0x42F, 0xDF, 0x131, 0x3C3, 0xFF41 };
+
+        mt19937 random{ 1 };
+        uniform_int_distribution<size_t> length{ 0, 40 };
+        uniform_int_distribution<size_t> letter{ 0, size(alphabet) - 1 };
+        uniform_int_distribution<int> percent{ 0, 99 };
+
+        for (int n = 0; n < 5000; ++n)
+        {
+            String a;
+            for (auto k = length(random); k > 0; --k)
+            {
+                a += alphabet[letter(random)];
+            }
+
+            auto b = a;
+            for (auto& c : b)
+            {
+                if (percent(random) < 20)
+                {
+                    c = percent(random) < 50 ? case_insensitive::to_upper(c) : alphabet[letter(random)];
+                }
+            }
+            if (percent(random) < 10)
+            {
+                b += alphabet[letter(random)];
+            }
+
+            check(a, b);
+        }
+    }
+
+    template <typename String>
+    void check_against_reference(const String& a, const String& b)
+    {
+        const auto expected = compare_reference(a, b);
+
+        Assert::AreEqual(expected, sign(case_insensitive::compare(a, b)));
+        Assert::AreEqual(-expected, sign(case_insensitive::compare(b, a)));
+        Assert::AreEqual(expected == 0, case_insensitive::equal(a, b));
+
+        if (expected == 0)
+        {
+            Assert::AreEqual(case_insensitive::hash_value(a), case_insensitive::hash_value(b));
+        }
+    }
+}
+
+TEST_CLASS(case_insensitive_test)
+{
+public:
+
+    TEST_METHOD(uppercases_like_the_registry)
+    {
+        Assert::IsTrue(L'A' == case_insensitive::to_upper(L'a'));
+        Assert::IsTrue(L'_' == case_insensitive::to_upper(L'_'));
+        Assert::IsTrue(L'\xC9' == case_insensitive::to_upper(L'\xE9'));
+        Assert::IsTrue(L'\x42F' == case_insensitive::to_upper(L'\x44F'));
+        Assert::IsTrue(u'\xFF21' == case_insensitive::to_upper(u'\xFF41'));
+
+        // One code unit maps to one code unit: no "SS" for sharp s.
+        Assert::IsTrue(L'\xDF' == case_insensitive::to_upper(L'\xDF'));
+        Assert::IsTrue(u'\xD801' == case_insensitive::to_upper(u'\xD801'));
+
+        // The simple mapping, not the full one: ypogegrammeni letters uppercase to their titlecase letter.
+        Assert::IsTrue(L'\x1F88' == case_insensitive::to_upper(L'\x1F80'));
+        Assert::IsTrue(L'\x1FFC' == case_insensitive::to_upper(L'\x1FF3'));
+        Assert::IsTrue(case_insensitive::equal(L"\x1F80\x1FB3", L"\x1F88\x1FBC"));
+        Assert::AreEqual(case_insensitive::hash_value(std::wstring_view{ L"\x1F80" }), case_insensitive::hash_value(std::wstring_view{ L"\x1F88" }));
+    }
+
+    TEST_METHOD(equality_and_ordering)
+    {
+        Assert::IsTrue(case_insensitive::equal(L"Software\\Classes\\CLSID", L"SOFTWARE\\classes\\clsid"));
+        Assert::IsTrue(case_insensitive::equal(L"\x41F\x440\x438\x432\x435\x442", L"\x43F\x420\x418\x412\x415\x422"));
+        Assert::IsFalse(case_insensitive::equal(L"InprocServer32", L"InprocServer64"));
+        Assert::IsFalse(case_insensitive::equal(L"abc", L"abcd"));
+
+        // Ordinal order of the uppercase code units: '_' (0x5F) sorts after 'a' (0x41 once uppercased).
+        Assert::IsTrue(case_insensitive::compare(L"a", L"_") < 0);
+        Assert::IsTrue(case_insensitive::compare(L"abc", L"ABCD") < 0);
+        Assert::AreEqual(0, case_insensitive::compare(L"", L""));
+    }
+
+    TEST_METHOD(wide_strings_match_reference)
+    {
+        for_each_random_pair<wstring>(&check_against_reference<wstring>);
+    }
+
+    TEST_METHOD(utf16_strings_match_reference)
+    {
+        for_each_random_pair<u16string>(&check_against_reference<u16string>);
+    }
+
+    TEST_METHOD(hash_spreads_different_strings)
+    {
+        // Strings that differ in one code unit of a vector block, or only in length, hash differently.
+        const auto base = wstring(24, L'a');
+        Assert::AreNotEqual(case_insensitive::hash_value(base), case_insensitive::hash_value(base + L'a'));
+        Assert::AreNotEqual(case_insensitive::hash_value(base), case_insensitive::hash_value(base + L'\0'));
+
+        for (size_t i = 0; i < base.size(); ++i)
+        {
+            auto other = base;
+            other[i] = L'b';
+            Assert::AreNotEqual(case_insensitive::hash_value(base), case_insensitive::hash_value(other));
+        }
+
+        Assert::AreEqual(case_insensitive::hash_value(L"\x430\x431\x432"), case_insensitive::hash_value(u"\x410\x411\x412"));
+    }
+
+    TEST_METHOD(function_objects_key_containers)
+    {
+        unordered_map<wstring, int, case_insensitive::hash, case_insensitive::equal_to> values;
+        values[L"ThreadingModel"] = 1;
+        values[L"THREADINGMODEL"] = 2;
+        Assert::AreEqual(size_t{ 1 }, values.size());
+        Assert::AreEqual(2, values.at(L"threadingmodel"));
+
+        map<wstring, int, case_insensitive::less> sorted{ { L"b", 2 }, { L"A", 1 }, { L"C", 3 } };
+        Assert::IsTrue(L"A" == sorted.begin()->first);
+        Assert::AreEqual(2, sorted.find(wstring_view{ L"B" })->second);
+    }
+
+    TEST_METHOD(path_is_a_hash_map_key)
+    {
+        const case_insensitive_path clsid{ L"Software\\Classes\\CLSID" };
+        const case_insensitive_path server = clsid / L"{6ED9970A-70E1-408C-AA5F-ADAA60BA8F17}";
+
+        Assert::IsTrue(server == case_insensitive_path{ L"SOFTWARE\\CLASSES\\clsid\\{6ed9970a-70e1-408c-aa5f-adaa60ba8f17}" });
+        Assert::IsTrue(server != clsid);
+        Assert::IsTrue(clsid < server);
+        Assert::AreEqual(case_insensitive::hash_value(server.str), std::hash<case_insensitive_path>{}(server));
+
+        unordered_map<case_insensitive_path, int> keys;
+        keys.emplace(clsid, 1);
+        keys.emplace(path{ L"software\\classes\\clsid" }, 2);
+        Assert::AreEqual(size_t{ 1 }, keys.size());
+        Assert::AreEqual(1, keys.at(case_insensitive_path{ L"SOFTWARE\\Classes\\Clsid" }));
+    }
+};
\ No newline at end of file
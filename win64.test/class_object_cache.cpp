@@ -0,0 +1,191 @@
+#include <CppUnitTest.h>
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "win64/class_object_cache.hpp"
+
+using namespace std;
+using namespace windows::com;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+    struct fake_class_object
+    {
+        int key;
+        unsigned long class_context;
+    };
+
+    //! Stand-in activation layer that counts activations.
+    //! Each test instantiates it with its own `Id` so that the tests do not share a cache.
+    //! Negative keys fail to activate, like an unregistered class.
+    template <int Id>
+    struct fake_activation_traits
+    {
+        using key_type = int;
+        using pointer = shared_ptr<fake_class_object>;
+
+        static atomic<int> activations;
+
+        static pointer get_class_object(const key_type& key, unsigned long class_context)
+        {
+            ++activations;
+
+            if (key < 0)
+            {
+                throw runtime_error{ "class not registered" };
+            }
+
+            return make_shared<fake_class_object>(fake_class_object{ key, class_context });
+        }
+    };
+
+    template <int Id>
+    atomic<int> fake_activation_traits<Id>::activations{ 0 };
+}
+
+TEST_CLASS(class_object_cache_test)
+{
+public:
+
+    TEST_METHOD(activates_once_per_key)
+    {
+        using traits = fake_activation_traits<0>;
+        using cache = class_object_cache<traits>;
+
+        const auto first = cache::get(1, 0);
+        const auto second = cache::get(1, 0);
+
+        Assert::AreEqual(1, traits::activations.load());
+        Assert::IsTrue(first == second);
+        Assert::AreEqual(size_t{ 1 }, cache::size());
+    }
+
+    TEST_METHOD(distinguishes_keys_and_class_contexts)
+    {
+        using traits = fake_activation_traits<1>;
+        using cache = class_object_cache<traits>;
+
+        const auto a = cache::get(1, 1);
+        const auto b = cache::get(2, 1);
+        const auto c = cache::get(1, 4);
+
+        Assert::AreEqual(3, traits::activations.load());
+        Assert::AreEqual(2, b->key);
+        Assert::AreEqual(4ul, c->class_context);
+        Assert::IsTrue(a == cache::get(1, 1));
+        Assert::AreEqual(3, traits::activations.load());
+    }
+
+    TEST_METHOD(flush_releases_class_objects)
+    {
+        using traits = fake_activation_traits<2>;
+        using cache = class_object_cache<traits>;
+
+        const weak_ptr<fake_class_object> cached = cache::get(1, 0);
+        Assert::IsFalse(cached.expired());
+
+        cache::flush();
+
+        Assert::IsTrue(cached.expired());
+        Assert::AreEqual(size_t{ 0 }, cache::size());
+
+        cache::get(1, 0);
+        Assert::AreEqual(2, traits::activations.load());
+    }
+
+    TEST_METHOD(failures_are_not_cached)
+    {
+        using traits = fake_activation_traits<3>;
+        using cache = class_object_cache<traits>;
+
+        Assert::ExpectException<runtime_error>([] { cache::get(-1, 0); });
+        Assert::ExpectException<runtime_error>([] { cache::get(-1, 0); });
+
+        Assert::AreEqual(2, traits::activations.load());
+        Assert::AreEqual(size_t{ 0 }, cache::size());
+    }
+
+    TEST_METHOD(caches_are_per_thread)
+    {
+        using traits = fake_activation_traits<4>;
+        using cache = class_object_cache<traits>;
+
+        const auto here = cache::get(1, 0);
+
+        shared_ptr<fake_class_object> there;
+        thread{ [&] { there = cache::get(1, 0); } }.join();
+
+        Assert::AreEqual(2, traits::activations.load());
+        Assert::IsTrue(here != there);
+    }
+
+    TEST_METHOD(flush_all_invalidates_other_threads)
+    {
+        using traits = fake_activation_traits<5>;
+        using cache = class_object_cache<traits>;
+
+        promise<void> populated;
+        promise<void> flushed;
+        size_t size_after_flush = 0;
+
+        thread worker{ [&]
+        {
+            cache::get(1, 0);
+            populated.set_value();
+
+            flushed.get_future().wait();
+            size_after_flush = cache::size();
+            cache::get(1, 0);
+        } };
+
+        populated.get_future().wait();
+        cache::flush_all();
+        flushed.set_value();
+        worker.join();
+
+        Assert::AreEqual(size_t{ 0 }, size_after_flush);
+        Assert::AreEqual(2, traits::activations.load());
+    }
+
+    TEST_METHOD(concurrent_lookups)
+    {
+        using traits = fake_activation_traits<6>;
+        using cache = class_object_cache<traits>;
+
+        constexpr int thread_count = 8;
+        constexpr int key_count = 4;
+        constexpr int iterations = 10000;
+
+        atomic<int> mismatches{ 0 };
+        vector<thread> threads;
+
+        for (int i = 0; i < thread_count; ++i)
+        {
+            threads.emplace_back([&]
+            {
+                for (int n = 0; n < iterations; ++n)
+                {
+                    const auto key = n % key_count;
+                    if (cache::get(key, 0)->key != key)
+                    {
+                        ++mismatches;
+                    }
+                }
+            });
+        }
+
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+
+        Assert::AreEqual(0, mismatches.load());
+        Assert::AreEqual(thread_count * key_count, traits::activations.load());
+    }
+};
@@ -0,0 +1,214 @@
+#include <CppUnitTest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+
+#include "win64/code_page.hpp"
+
+using namespace std;
+using namespace windows::locale;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+    const code_page all_code_pages[] = { code_page::windows_1252, code_page::windows_1251, code_page::oem_437 };
+
+    //! Every byte value in turn, long enough to run through the vector kernels several times, plus a tail.
+    string all_bytes(size_t repeat = 3)
+    {
+        string bytes;
+        for (size_t r = 0; r < repeat; ++r)
+        {
+            for (int b = 0; b < 256; ++b)
+            {
+                bytes += static_cast<char>(b);
+            }
+        }
+        return bytes + "tail";
+    }
+
+    //! Reference decoder: one table lookup per byte.
+    u16string decode_reference(code_page cp, const string& bytes)
+    {
+        const auto& t = windows::locale::detail::table(cp);
+        u16string text;
+        for (const auto b : bytes)
+        {
+            const auto c = t.to_unicode[static_cast<unsigned char>(b)];
+            text += c == 0xFFFF ? u'\xFFFD' : static_cast<char16_t>(c);
+        }
+        return text;
+    }
+
+    //! Reference UTF-8 encoder for the Basic Multilingual Plane.
+    string utf8_reference(const u16string& text)
+    {
+        string utf8;
+        for (const char32_t c : text)
+        {
+            if (c < 0x80)
+            {
+                utf8 += static_cast<char>(c);
+            }
+            else if (c < 0x800)
+            {
+                utf8 += static_cast<char>(0xC0 | (c >> 6));
+                utf8 += static_cast<char>(0x80 | (c & 0x3F));
+            }
+            else
+            {
+                utf8 += static_cast<char>(0xE0 | (c >> 12));
+                utf8 += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                utf8 += static_cast<char>(0x80 | (c & 0x3F));
+            }
+        }
+        return utf8;
+    }
+
+    //! The bytes of `all_bytes` that the code page defines, in a shuffled order.
+    string defined_bytes(code_page cp)
+    {
+        const auto& t = windows::locale::detail::table(cp);
+        string bytes;
+        for (const auto b : all_bytes(8))
+        {
+            if (t.to_unicode[static_cast<unsigned char>(b)] != 0xFFFF)
+            {
+                bytes += b;
+            }
+        }
+
+        shuffle(bytes.begin(), bytes.end(), mt19937{ 1 });
+        return bytes;
+    }
+}
+
+TEST_CLASS(code_page_test)
+{
+public:
+
+    TEST_METHOD(known_mappings)
+    {
+        Assert::IsTrue(code_page_to_utf16(code_page::windows_1252, "\x80\x9F\xE9") == u"€Ÿé");
+        Assert::IsTrue(code_page_to_utf16(code_page::windows_1251, "\xC0\xFF\xA8") == u"АяЁ");
+        Assert::IsTrue(code_page_to_utf16(code_page::oem_437, "\xB0\xDB\xE1") == u"░█ß");
+
+        Assert::IsTrue(utf16_to_code_page(code_page::windows_1252, u"€Ÿé") == "\x80\x9F\xE9");
+        Assert::IsTrue(utf16_to_code_page(code_page::windows_1251, u"АяЁ") == "\xC0\xFF\xA8");
+        Assert::IsTrue(utf16_to_code_page(code_page::oem_437, u"░█ß") == "\xB0\xDB\xE1");
+
+        Assert::IsTrue(code_page_to_utf8(code_page::windows_1252, "caf\xE9 \x80") == u8"café €");
+        Assert::IsTrue(utf8_to_code_page(code_page::windows_1251, u8"Привет") == "\xCF\xF0\xE8\xE2\xE5\xF2");
+    }
+
+    TEST_METHOD(decoding_matches_reference)
+    {
+        const auto bytes = all_bytes();
+
+        for (const auto cp : all_code_pages)
+        {
+            const auto expected = decode_reference(cp, bytes);
+            Assert::IsTrue(expected == code_page_to_utf16(cp, bytes, conversion_mode::lossy));
+            Assert::IsTrue(utf8_reference(expected) == code_page_to_utf8(cp, bytes, conversion_mode::lossy));
+
+            const auto wide = code_page_to_wide(cp, bytes, conversion_mode::lossy);
+            Assert::IsTrue(wstring(expected.begin(), expected.end()) == wide);
+        }
+    }
+
+    TEST_METHOD(round_trips_defined_bytes)
+    {
+        for (const auto cp : all_code_pages)
+        {
+            const auto bytes = defined_bytes(cp);
+
+            const auto utf16 = code_page_to_utf16(cp, bytes);
+            Assert::IsTrue(bytes == utf16_to_code_page(cp, utf16));
+            Assert::IsTrue(bytes == wide_to_code_page(cp, code_page_to_wide(cp, bytes)));
+            Assert::IsTrue(bytes == utf8_to_code_page(cp, code_page_to_utf8(cp, bytes)));
+        }
+    }
+
+    TEST_METHOD(strict_mode_rejects_undefined_bytes)
+    {
+        // 0x81 is undefined in 1252; put it after a run of ASCII so that the vector kernels find it.
+        const auto bytes = string(37, 'a') + "\x81" + string(20, 'b');
+
+        Assert::ExpectException<range_error>([&] { code_page_to_utf16(code_page::windows_1252, bytes); });
+        Assert::ExpectException<range_error>([&] { code_page_to_wide(code_page::windows_1252, bytes); });
+        Assert::ExpectException<range_error>([&] { code_page_to_utf8(code_page::windows_1252, bytes); });
+
+        const auto lossy = code_page_to_utf16(code_page::windows_1252, bytes, conversion_mode::lossy);
+        Assert::IsTrue(u'\xFFFD' == lossy[37]);
+        Assert::AreEqual(bytes.size(), lossy.size());
+
+        // 1251 and 437 define every byte except 0x98 in 1251.
+        Assert::ExpectException<range_error>([] { code_page_to_utf16(code_page::windows_1251, "\x98"); });
+        Assert::IsTrue(decode_reference(code_page::oem_437, all_bytes()) == code_page_to_utf16(code_page::oem_437, all_bytes()));
+    }
+
+    TEST_METHOD(strict_mode_rejects_unmappable_characters)
+    {
+        const auto text = u16string(20, u'a') + u"А" + u16string(20, u'b');
+
+        Assert::ExpectException<range_error>([&] { utf16_to_code_page(code_page::windows_1252, text); });
+        Assert::ExpectException<range_error>([] { utf8_to_code_page(code_page::windows_1252, u8"中"); });
+        Assert::ExpectException<range_error>([] { utf8_to_code_page(code_page::windows_1252, "\xC3"); });
+
+        const auto lossy = utf16_to_code_page(code_page::windows_1252, text, conversion_mode::lossy);
+        Assert::AreEqual('?', lossy[20]);
+        Assert::AreEqual(text.size(), lossy.size());
+    }
+
+    TEST_METHOD(lossy_mode_replaces_surrogate_pairs_once)
+    {
+        Assert::IsTrue("a?b" == utf16_to_code_page(code_page::windows_1252, u"a\U0001F600b", conversion_mode::lossy));
+        Assert::IsTrue("a?b" == utf8_to_code_page(code_page::windows_1252, u8"a\U0001F600b", conversion_mode::lossy));
+        Assert::IsTrue("a??b" == utf8_to_code_page(code_page::windows_1252, "a\xFF\xC3" "b", conversion_mode::lossy));
+    }
+
+    TEST_METHOD(streams_utf8_split_across_chunks)
+    {
+        const string text = u8"Привет, мир! Съешь же ещё этих мягких французских булок.";
+        const auto expected = utf8_to_code_page(code_page::windows_1251, text);
+
+        for (size_t chunk_size = 1; chunk_size < 8; ++chunk_size)
+        {
+            utf8_to_code_page_converter converter{ code_page::windows_1251 };
+            string output;
+            for (size_t i = 0; i < text.size(); i += chunk_size)
+            {
+                converter.convert(string_view{ text }.substr(i, chunk_size), output);
+            }
+            converter.finish(output);
+
+            Assert::IsTrue(expected == output);
+        }
+
+        utf8_to_code_page_converter truncated{ code_page::windows_1251, conversion_mode::lossy };
+        string output;
+        truncated.convert("ab\xD0", output);
+        Assert::IsTrue("ab" == output);
+        truncated.finish(output);
+        Assert::IsTrue("ab?" == output);
+    }
+
+    TEST_METHOD(streams_decoding_by_appending)
+    {
+        const auto bytes = defined_bytes(code_page::windows_1252);
+
+        u16string output;
+        for (size_t i = 0; i < bytes.size(); i += 100)
+        {
+            code_page_to_utf16(code_page::windows_1252, string_view{ bytes }.substr(i, 100), output);
+        }
+
+        Assert::IsTrue(code_page_to_utf16(code_page::windows_1252, bytes) == output);
+    }
+
+    TEST_METHOD(rejects_unsupported_code_pages)
+    {
+        Assert::ExpectException<invalid_argument>([] { code_page_to_utf16(static_cast<code_page>(65001), "a"); });
+    }
+};
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include <CppUnitTest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "win64/deferred_close.hpp"
+
+using namespace std;
+using namespace windows;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+    //! Handles are positive integers. Each test uses its own `Id`, so that it gets its own closer and counters.
+    template <int Id>
+    struct fake_handle_traits
+    {
+        using pointer = int;
+
+        static mutex lock;
+        static vector<int> closed;
+        static vector<thread::id> closing_threads;
+        static chrono::microseconds close_time;
+        static atomic<bool> held; //!< While set, closes wait, so that the queue fills up
+
+        static auto invalid() throw() -> pointer
+        {
+            return 0;
+        }
+
+        static auto close(pointer value) throw() -> void
+        {
+            while (held)
+            {
+                this_thread::yield();
+            }
+
+            this_thread::sleep_for(close_time);
+
+            lock_guard<mutex> guard{ lock };
+            closed.push_back(value);
+            closing_threads.push_back(this_thread::get_id());
+        }
+
+        static vector<int> closed_handles()
+        {
+            lock_guard<mutex> guard{ lock };
+            return closed;
+        }
+    };
+
+    template <int Id> mutex fake_handle_traits<Id>::lock;
+    template <int Id> vector<int> fake_handle_traits<Id>::closed;
+    template <int Id> vector<thread::id> fake_handle_traits<Id>::closing_threads;
+    template <int Id> chrono::microseconds fake_handle_traits<Id>::close_time{ 0 };
+    template <int Id> atomic<bool> fake_handle_traits<Id>::held{ false };
+
+    template <int Id>
+    using fake_handle = unique_handle<deferred_close_traits<fake_handle_traits<Id>>>;
+}
+
+TEST_CLASS(deferred_close_test)
+{
+public:
+
+    TEST_METHOD(closes_on_a_background_thread)
+    {
+        using traits = fake_handle_traits<1>;
+
+        {
+            fake_handle<1> a{ 1 };
+            fake_handle<1> b{ 2 };
+            fake_handle<1> empty;
+        }
+
+        deferred_closer<traits>::flush();
+
+        Assert::IsTrue(vector<int>{ 2, 1 } == traits::closed_handles());
+        for (const auto id : traits::closing_threads)
+        {
+            Assert::IsTrue(id != this_thread::get_id());
+        }
+    }
+
+    TEST_METHOD(flush_waits_for_slow_closes)
+    {
+        using traits = fake_handle_traits<2>;
+        traits::close_time = chrono::milliseconds{ 2 };
+        traits::held = true;
+
+        for (int i = 1; i <= 20; ++i)
+        {
+            fake_handle<2> h{ i };
+            h.reset(i + 100);
+        }
+
+        Assert::IsTrue(deferred_closer<traits>::depth() > 0, L"depth");
+        traits::held = false;
+        deferred_closer<traits>::flush();
+
+        const auto closed = traits::closed_handles();
+        Assert::AreEqual(size_t{ 40 }, closed.size());
+
+        // Queued handles are closed in order.
+        for (int i = 1; i <= 20; ++i)
+        {
+            Assert::AreEqual(i, closed[2 * (i - 1)]);
+            Assert::AreEqual(i + 100, closed[2 * (i - 1) + 1]);
+        }
+
+        const auto statistics = deferred_closer<traits>::statistics();
+        Assert::AreEqual(40ull, statistics.enqueued);
+        Assert::AreEqual(40ull, statistics.closed);
+        Assert::AreEqual(0ull, statistics.pending());
+        Assert::AreEqual(1ull, statistics.flushes);
+        Assert::IsTrue(statistics.largest_batch > 1, L"largest_batch");
+    }
+
+    TEST_METHOD(concurrent_producers_and_flushes)
+    {
+        using traits = fake_handle_traits<3>;
+        constexpr int thread_count = 8;
+        constexpr int iterations = 5000;
+
+        vector<thread> threads;
+        for (int t = 0; t < thread_count; ++t)
+        {
+            threads.emplace_back([=]
+            {
+                for (int i = 1; i <= iterations; ++i)
+                {
+                    fake_handle<3>{ t * iterations + i };
+
+                    // Every thread can wait for its own handles while the others keep queueing.
+                    if (i % 1000 == 0)
+                    {
+                        deferred_closer<traits>::flush();
+                    }
+                }
+            });
+        }
+
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+
+        deferred_closer<traits>::flush();
+
+        auto closed = traits::closed_handles();
+        sort(closed.begin(), closed.end());
+        Assert::AreEqual(size_t{ thread_count * iterations }, closed.size());
+        for (int i = 0; i < thread_count * iterations; ++i)
+        {
+            Assert::AreEqual(i + 1, closed[i]);
+        }
+
+        const auto statistics = deferred_closer<traits>::statistics();
+        Assert::AreEqual(0ull, statistics.pending());
+        Assert::AreEqual(static_cast<unsigned long long>(thread_count * iterations / 1000 + 1), statistics.flushes);
+        Assert::IsTrue(statistics.batches >= 1);
+    }
+
+    TEST_METHOD(flush_with_nothing_queued)
+    {
+        deferred_closer<fake_handle_traits<4>>::flush();
+        Assert::AreEqual(0ull, deferred_closer<fake_handle_traits<4>>::depth());
+    }
+
+    TEST_METHOD(first_used_by_flush)
+    {
+        // Starting the closer with `flush` must still build the memory pool first, so that the pool outlives it.
+        using traits = fake_handle_traits<5>;
+        deferred_closer<traits>::flush();
+        Assert::AreEqual(0ull, deferred_closer<traits>::statistics().enqueued);
+
+        for (int i = 1; i <= 100; ++i)
+        {
+            fake_handle<5>{ i };
+        }
+
+        deferred_closer<traits>::flush();
+        Assert::AreEqual(100ull, deferred_closer<traits>::statistics().closed);
+        Assert::AreEqual(static_cast<size_t>(100), traits::closed_handles().size());
+    }
+
+    TEST_METHOD(closes_real_handles)
+    {
+        auto event = ::CreateEvent(nullptr, TRUE, FALSE, nullptr);
+        {
+            deferred_null_handle h{ event };
+        }
+
+        deferred_closer<null_handle_traits>::flush();
+        Assert::AreEqual(1ull, deferred_closer<null_handle_traits>::statistics().closed);
+    }
+};
\ No newline at end of file
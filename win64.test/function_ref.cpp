@@ -0,0 +1,122 @@
+#include <CppUnitTest.h>
+
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+#include "win64/function_ref.hpp"
+#include "win64/ktm.hpp"
+
+using namespace std;
+using namespace windows;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+    int twice(int x)
+    {
+        return 2 * x;
+    }
+
+    int call(function_ref<int(int)> f, int x)
+    {
+        return f(x);
+    }
+}
+
+TEST_CLASS(function_ref_test)
+{
+public:
+
+    TEST_METHOD(calls_lambdas_and_functions)
+    {
+        Assert::AreEqual(6, call([](int x) { return x + 3; }, 3));
+        Assert::AreEqual(6, call(&twice, 3));
+
+        const std::function<int(int)> f = [](int x) { return x * x; };
+        Assert::AreEqual(9, call(f, 3));
+    }
+
+    TEST_METHOD(refers_to_the_callable)
+    {
+        int calls = 0;
+        auto counter = [&calls](int x) { ++calls; return x; };
+
+        const function_ref<int(int)> ref{ counter };
+        ref(1);
+        ref(2);
+
+        // Not a copy: the lambda's state is shared.
+        Assert::AreEqual(2, calls);
+        Assert::IsTrue(sizeof(ref) <= 2 * sizeof(void*));
+    }
+
+    TEST_METHOD(stores_functions_by_value)
+    {
+        // The pointers are temporaries, so these must hold the pointers themselves.
+        const function_ref<int(int)> by_pointer = &twice;
+        const function_ref<int(int)> by_name{ twice };
+
+        Assert::AreEqual(6, by_pointer(3));
+        Assert::AreEqual(8, by_name(4));
+    }
+
+    TEST_METHOD(discards_results_for_void)
+    {
+        string s;
+        auto append_to_s = [&s](const char* text) { s += text; return s.size(); };
+        const function_ref<void(const char*)> append{ append_to_s };
+        append("ab");
+        append("c");
+
+        Assert::AreEqual(string{ "abc" }, s);
+    }
+};
+
+// Tells a commit from a rollback with the commit counter of the KTM stand-in in `compat`, which is not used on Windows.
+#if !defined(_WIN32)
+TEST_CLASS(transact_test)
+{
+public:
+
+    TEST_METHOD(commits_after_action)
+    {
+        const auto before = compat::committed_transactions.load();
+
+        int calls = 0;
+        ktm::transact([&](const ktm::transaction& t)
+        {
+            Assert::IsTrue(t.get() != nullptr);
+            ++calls;
+        });
+
+        Assert::AreEqual(1, calls);
+        Assert::AreEqual(before + 1, compat::committed_transactions.load());
+    }
+
+    TEST_METHOD(does_not_commit_after_exception)
+    {
+        const auto before = compat::committed_transactions.load();
+
+        Assert::ExpectException<runtime_error>([]
+        {
+            ktm::transact([](const ktm::transaction&) { throw runtime_error{ "failed" }; });
+        });
+
+        Assert::AreEqual(before, compat::committed_transactions.load());
+    }
+
+    TEST_METHOD(accepts_function_ref_and_std_function)
+    {
+        const auto before = compat::committed_transactions.load();
+
+        int calls = 0;
+        auto action = [&](const ktm::transaction&) { ++calls; };
+        ktm::transact(function_ref<void(const ktm::transaction&)>{ action });
+        ktm::transact(std::function<void(const ktm::transaction&)>{ action });
+
+        Assert::AreEqual(2, calls);
+        Assert::AreEqual(before + 2, compat::committed_transactions.load());
+    }
+};
+#endif
\ No newline at end of file
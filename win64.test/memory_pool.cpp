@@ -0,0 +1,280 @@
+#include <CppUnitTest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "win64/memory_pool.hpp"
+
+using namespace std;
+using namespace windows::memory;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+    //! Mimics a COM object: reference counted, destroyed through a virtual destructor by its final `release`.
+    struct object_base
+    {
+        virtual ~object_base() = default;
+
+        void release()
+        {
+            if (--references == 0)
+            {
+                delete this;
+            }
+        }
+
+        atomic<unsigned long> references{ 1 };
+    };
+
+    atomic<int> live_objects{ 0 };
+
+    //! Frees a block, and allocates and frees another, from a `thread_local` destructor that runs after the pool's cache is gone.
+    struct late_release
+    {
+        void* block = nullptr;
+
+        ~late_release()
+        {
+            memory_pool::deallocate(block, 64);
+            memory_pool::deallocate(memory_pool::allocate(64), 64);
+        }
+    };
+
+    struct pooled_object : public object_base, public pooled_allocation<pooled_object>
+    {
+        pooled_object()
+        {
+            ++live_objects;
+        }
+
+        ~pooled_object() override
+        {
+            --live_objects;
+        }
+
+        char payload[40];
+    };
+
+    struct throwing_object : public pooled_allocation<throwing_object>
+    {
+        throwing_object()
+        {
+            throw 42;
+        }
+
+        char payload[24];
+    };
+
+    struct plain_object
+    {
+        char payload[40];
+    };
+
+    //! Like WRL's `Details::DontUseNewUseMake`, a base of every `RuntimeClass`, which hides `operator new`.
+    class dont_use_new
+    {
+    private:
+        static void* operator new(std::size_t) noexcept
+        {
+            return nullptr;
+        }
+
+    public:
+        static void* operator new(std::size_t, void* placement) noexcept
+        {
+            return placement;
+        }
+    };
+
+    struct runtime_class : public object_base, public dont_use_new, public pooled_allocation<runtime_class>
+    {
+        explicit runtime_class(int value) :
+            value{ value }
+        {
+            ++live_objects;
+        }
+
+        ~runtime_class() override
+        {
+            --live_objects;
+        }
+
+        int value;
+    };
+}
+
+TEST_CLASS(memory_pool_test)
+{
+public:
+
+    TEST_METHOD(blocks_are_aligned_and_distinct)
+    {
+        vector<void*> blocks;
+        for (size_t size = 0; size <= memory_pool::max_block_size; size += 8)
+        {
+            const auto block = memory_pool::allocate(size);
+            Assert::IsTrue(block != nullptr);
+            Assert::AreEqual(size_t{ 0 }, reinterpret_cast<uintptr_t>(block) % memory_pool::granularity);
+            memset(block, 0xCD, size);
+            blocks.push_back(block);
+        }
+
+        Assert::AreEqual(blocks.size(), set<void*>(blocks.begin(), blocks.end()).size());
+
+        size_t size = 0;
+        for (const auto block : blocks)
+        {
+            memory_pool::deallocate(block, size);
+            size += 8;
+        }
+    }
+
+    TEST_METHOD(freed_blocks_are_reused)
+    {
+        const auto first = memory_pool::allocate(48);
+        memory_pool::deallocate(first, 48);
+
+        const auto second = memory_pool::allocate(40);
+        Assert::IsTrue(first == second);
+        memory_pool::deallocate(second, 40);
+    }
+
+    TEST_METHOD(counts_allocations)
+    {
+        const auto before = memory_pool::statistics();
+
+        const auto small = memory_pool::allocate(16);
+        const auto large = memory_pool::allocate(memory_pool::max_block_size + 1);
+        memory_pool::deallocate(small, 16);
+        memory_pool::deallocate(large, memory_pool::max_block_size + 1);
+
+        const auto after = memory_pool::statistics();
+        Assert::AreEqual(before.allocations + 1, after.allocations);
+        Assert::AreEqual(before.deallocations + 1, after.deallocations);
+        Assert::AreEqual(before.oversize_allocations + 1, after.oversize_allocations);
+        Assert::IsTrue(after.chunks > 0);
+    }
+
+    TEST_METHOD(pooled_class_is_released_to_the_pool)
+    {
+        const auto before = memory_pool::statistics();
+
+        object_base* object = new (nothrow) pooled_object{};
+        Assert::AreEqual(1, live_objects.load());
+
+        object->release();
+        Assert::AreEqual(0, live_objects.load());
+
+        const auto after = memory_pool::statistics();
+        Assert::AreEqual(before.allocations + 1, after.allocations);
+        Assert::AreEqual(before.deallocations + 1, after.deallocations);
+    }
+
+    TEST_METHOD(throwing_constructor_releases_memory)
+    {
+        const auto before = memory_pool::statistics();
+
+        Assert::ExpectException<int>([] { new (nothrow) throwing_object{}; });
+        Assert::ExpectException<int>([] { new throwing_object{}; });
+        Assert::ExpectException<int>([] { pooled_allocation<throwing_object>::create(); });
+
+        const auto after = memory_pool::statistics();
+        Assert::AreEqual(before.allocations + 3, after.allocations);
+        Assert::AreEqual(before.deallocations + 3, after.deallocations);
+    }
+
+    TEST_METHOD(create_works_when_another_base_declares_operator_new)
+    {
+        const auto before = memory_pool::statistics();
+
+        const auto object = pooled_allocation<runtime_class>::create(7);
+        Assert::IsTrue(object != nullptr);
+        Assert::AreEqual(7, object->value);
+        Assert::AreEqual(1, live_objects.load());
+
+        object->release();
+        Assert::AreEqual(0, live_objects.load());
+
+        const auto after = memory_pool::statistics();
+        Assert::AreEqual(before.allocations + 1, after.allocations);
+        Assert::AreEqual(before.deallocations + 1, after.deallocations);
+    }
+
+    TEST_METHOD(opt_in_is_detected)
+    {
+        Assert::IsTrue(is_pooled<pooled_object>);
+        Assert::IsFalse(is_pooled<plain_object>);
+    }
+
+    TEST_METHOD(objects_released_on_other_threads)
+    {
+        constexpr int thread_count = 4;
+        constexpr int object_count = 20000;
+
+        const auto before = memory_pool::statistics();
+
+        // Each thread allocates objects that the next thread releases.
+        vector<vector<object_base*>> objects(thread_count);
+        vector<thread> threads;
+
+        for (int i = 0; i < thread_count; ++i)
+        {
+            threads.emplace_back([&objects, i]
+            {
+                for (int n = 0; n < object_count; ++n)
+                {
+                    objects[i].push_back(new pooled_object{});
+                }
+            });
+        }
+
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+
+        threads.clear();
+
+        for (int i = 0; i < thread_count; ++i)
+        {
+            threads.emplace_back([&objects, i]
+            {
+                for (const auto object : objects[(i + 1) % thread_count])
+                {
+                    object->release();
+                }
+            });
+        }
+
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+
+        const auto after = memory_pool::statistics();
+        Assert::AreEqual(0, live_objects.load());
+        Assert::AreEqual(before.allocations + thread_count * object_count, after.allocations);
+        Assert::AreEqual(before.deallocations + thread_count * object_count, after.deallocations);
+    }
+
+    TEST_METHOD(blocks_released_after_the_thread_cache_is_destroyed)
+    {
+        const auto before = memory_pool::statistics();
+
+        thread{ []
+        {
+            // Constructed before the pool's cache, so destroyed after it.
+            thread_local late_release late;
+            late.block = memory_pool::allocate(64);
+        } }.join();
+
+        const auto after = memory_pool::statistics();
+        Assert::AreEqual(before.allocations + 2, after.allocations);
+        Assert::AreEqual(before.deallocations + 2, after.deallocations);
+    }
+};
\ No newline at end of file
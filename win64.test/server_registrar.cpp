@@ -0,0 +1,92 @@
+#include <CppUnitTest.h>
+
+#include <string>
+
+#include "win64/arena.hpp"
+#include "win64/server_registrar.hpp"
+
+using namespace std;
+using namespace windows;
+using namespace windows::com::server;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+    //! The string value `name` of `HKEY_CURRENT_USER\key`, or an empty optional if it does not exist.
+    optional<wstring> get_value(const wstring& key, const wchar_t* name)
+    {
+        wchar_t data[256];
+        DWORD size = sizeof(data);
+        if (::RegGetValueW(HKEY_CURRENT_USER, key.c_str(), name, RRF_RT_REG_SZ, nullptr, data, &size) != ERROR_SUCCESS)
+        {
+            return nullopt;
+        }
+
+        return wstring{ data };
+    }
+
+    const wstring root = L"Software\\win64.test\\{6ED9970A-70E1-408C-AA5F-ADAA60BA8F17}";
+}
+
+TEST_CLASS(server_registrar_test)
+{
+public:
+
+    TEST_METHOD(register_unregister_test)
+    {
+        const path key{ root };
+        const server_registrar registrar{
+            {
+                { key, true, nullopt, L"win64.test class" },
+                { key / L"InprocServer32", false, nullopt, L"win64.test.dll" },
+                { key / L"InprocServer32", false, L"ThreadingModel", L"Both" },
+            },
+            registry::hive::current_user };
+
+        registrar.register_entries();
+
+        Assert::AreEqual(wstring{ L"win64.test class" }, *get_value(root, nullptr));
+        Assert::AreEqual(wstring{ L"win64.test.dll" }, *get_value(root + L"\\InprocServer32", nullptr));
+        Assert::AreEqual(wstring{ L"Both" }, *get_value(root + L"\\InprocServer32", L"ThreadingModel"));
+
+        registrar.unregister_entries();
+
+        Assert::IsFalse(get_value(root, nullptr).has_value());
+        Assert::IsFalse(get_value(root + L"\\InprocServer32", L"ThreadingModel").has_value());
+    }
+
+    TEST_METHOD(set_value_string_test)
+    {
+        const ktm::transaction transaction;
+        const auto key = registry::create_key(registry::hive::current_user, root.c_str(), KEY_SET_VALUE, transaction);
+
+        registry::set_value_string(key.get(), L"ThreadingModel", L"Both");
+        registry::set_value_string(key.get(), nullopt, L"win64.test class");
+
+        Assert::AreEqual(wstring{ L"Both" }, *get_value(root, L"ThreadingModel"));
+        Assert::AreEqual(wstring{ L"win64.test class" }, *get_value(root, nullptr));
+
+        registry::delete_subtree(registry::hive::current_user, root.c_str(), transaction);
+    }
+
+    TEST_METHOD(register_pmr_test)
+    {
+        memory::scoped_arena<> arena;
+        const auto allocator = arena.allocator<wchar_t>();
+
+        const windows::pmr::path key{ root, allocator };
+        com::server::pmr::server_registrar::container_type entries{ arena.allocator<com::server::pmr::registry_entry>() };
+        entries.push_back({ key, true, nullopt, std::pmr::wstring{ L"win64.test class", allocator } });
+        entries.push_back({ key / L"InprocServer32", false, std::pmr::wstring{ L"ThreadingModel", allocator }, std::pmr::wstring{ L"Apartment", allocator } });
+
+        const com::server::pmr::server_registrar registrar{ std::move(entries), registry::hive::current_user };
+        registrar.register_entries();
+
+        Assert::AreEqual(wstring{ L"win64.test class" }, *get_value(root, nullptr));
+        Assert::AreEqual(wstring{ L"Apartment" }, *get_value(root + L"\\InprocServer32", L"ThreadingModel"));
+
+        registrar.unregister_entries();
+
+        Assert::IsFalse(get_value(root, nullptr).has_value());
+    }
+};
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include <CppUnitTest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "win64/telemetry.hpp"
+
+using namespace std;
+using namespace windows::telemetry;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+    // Counters are process-wide and never reset, so each test uses its own `HRESULT`s and compares snapshots.
+    constexpr long fake_hresult(long n)
+    {
+        return static_cast<long>(0x80040000L + n);
+    }
+
+    unsigned long long count_of(const vector<failure_count>& counts, long hresult, failure_source source)
+    {
+        for (const auto& c : counts)
+        {
+            if (c.hresult == hresult && c.source == source)
+            {
+                return c.count;
+            }
+        }
+
+        return 0;
+    }
+
+    unsigned long long count_of(long hresult, failure_source source)
+    {
+        return count_of(snapshot(), hresult, source);
+    }
+}
+
+TEST_CLASS(telemetry_test)
+{
+public:
+
+    TEST_METHOD(counts_by_hresult_and_source)
+    {
+        const auto a = fake_hresult(1);
+        const auto b = fake_hresult(2);
+
+        record_failure(failure_source::throw_if_failed, a);
+        record_failure(failure_source::throw_if_failed, a);
+        record_failure(failure_source::exception, a);
+        record_failure(failure_source::timeout, b);
+
+        Assert::AreEqual(2ull, count_of(a, failure_source::throw_if_failed));
+        Assert::AreEqual(1ull, count_of(a, failure_source::exception));
+        Assert::AreEqual(0ull, count_of(a, failure_source::entry_point));
+        Assert::AreEqual(1ull, count_of(b, failure_source::timeout));
+    }
+
+    TEST_METHOD(snapshot_is_sorted)
+    {
+        record_failure(failure_source::entry_point, fake_hresult(4));
+        record_failure(failure_source::entry_point, fake_hresult(3));
+
+        const auto counts = snapshot();
+        for (size_t i = 1; i < counts.size(); ++i)
+        {
+            Assert::IsTrue(counts[i - 1].hresult < counts[i].hresult
+                || (counts[i - 1].hresult == counts[i].hresult && counts[i - 1].source < counts[i].source));
+        }
+    }
+
+    TEST_METHOD(counts_survive_thread_exit)
+    {
+        const auto hr = fake_hresult(5);
+
+        thread{ [=]
+        {
+            record_failure(failure_source::exception, hr);
+            record_failure(failure_source::exception, hr);
+        } }.join();
+
+        Assert::AreEqual(2ull, count_of(hr, failure_source::exception));
+    }
+
+    TEST_METHOD(each_pair_appears_once)
+    {
+        const auto hr = fake_hresult(7);
+
+        record_failure(failure_source::exception, hr);
+        for (int i = 0; i < 2; ++i)
+        {
+            thread{ [=] { record_failure(failure_source::exception, hr); } }.join();
+        }
+
+        const auto counts = snapshot();
+        const auto matches = count_if(counts.begin(), counts.end(), [=](const failure_count& c)
+        {
+            return c.hresult == hr && c.source == failure_source::exception;
+        });
+
+        Assert::AreEqual(static_cast<ptrdiff_t>(1), static_cast<ptrdiff_t>(matches));
+        Assert::AreEqual(3ull, count_of(counts, hr, failure_source::exception));
+    }
+
+    TEST_METHOD(overflow_is_counted)
+    {
+        const auto capacity = static_cast<long>(windows::telemetry::detail::failure_table::capacity);
+
+        const auto before = count_of(0, failure_source::timeout);
+
+        thread{ [=]
+        {
+            for (long i = 0; i < capacity + 10; ++i)
+            {
+                record_failure(failure_source::timeout, fake_hresult(1000 + i));
+            }
+        } }.join();
+
+        Assert::AreEqual(before + 10, count_of(0, failure_source::timeout));
+    }
+
+    TEST_METHOD(concurrent_recording_and_snapshots)
+    {
+        constexpr int thread_count = 8;
+        constexpr int iterations = 20000;
+        const auto hr = fake_hresult(6);
+
+        atomic<bool> done{ false };
+        atomic<bool> decreased{ false };
+        thread reader{ [&]
+        {
+            unsigned long long last = 0;
+            while (!done)
+            {
+                const auto current = count_of(hr, failure_source::throw_if_failed);
+                if (current < last)
+                {
+                    decreased = true;
+                }
+                last = current;
+            }
+        } };
+
+        vector<thread> writers;
+        for (int i = 0; i < thread_count; ++i)
+        {
+            writers.emplace_back([=]
+            {
+                for (int n = 0; n < iterations; ++n)
+                {
+                    record_failure(failure_source::throw_if_failed, hr);
+                }
+            });
+        }
+
+        for (auto& t : writers)
+        {
+            t.join();
+        }
+
+        done = true;
+        reader.join();
+
+        Assert::IsFalse(decreased);
+        Assert::AreEqual(static_cast<unsigned long long>(thread_count) * iterations, count_of(hr, failure_source::throw_if_failed));
+    }
+};
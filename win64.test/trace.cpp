@@ -0,0 +1,207 @@
+#include <CppUnitTest.h>
+
+#include "win64/trace.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace windows::trace;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+    string temporary_trace_path(const char* name)
+    {
+        return (filesystem::temp_directory_path() / name).string();
+    }
+
+    vector<decoded_event> read_file(const string& path)
+    {
+        ifstream input{ path, ios::binary };
+        return read(input);
+    }
+
+    void traced_work(int n)
+    {
+        WIN64_TRACE_SPAN(event_id::user, n);
+        WIN64_TRACE_EVENT(static_cast<uint32_t>(event_id::user) + 1, n * 2);
+    }
+}
+
+TEST_CLASS(ring_buffer_test)
+{
+public:
+
+    TEST_METHOD(drains_in_order_across_wraparound)
+    {
+        ring_buffer ring{ 1 };
+        vector<uint64_t> payloads;
+        const auto collect = [&](const event* events, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                payloads.push_back(events[i].payload);
+            }
+        };
+
+        for (uint64_t i = 0; i < ring_buffer::capacity - 10; ++i)
+        {
+            ring.push(event{ 0, 1, event_kind::instant, i });
+        }
+        ring.drain(collect);
+
+        payloads.clear();
+        for (uint64_t i = 0; i < 20; ++i)
+        {
+            ring.push(event{ 0, 1, event_kind::instant, i });
+        }
+
+        Assert::AreEqual(size_t{ 20 }, ring.drain(collect));
+        for (uint64_t i = 0; i < 20; ++i)
+        {
+            Assert::AreEqual(i, payloads[i]);
+        }
+    }
+
+    TEST_METHOD(drops_events_when_full)
+    {
+        ring_buffer ring{ 1 };
+
+        for (size_t i = 0; i < ring_buffer::capacity; ++i)
+        {
+            Assert::IsTrue(ring.push(event{}));
+        }
+
+        Assert::IsFalse(ring.push(event{}));
+        Assert::AreEqual(uint64_t{ 1 }, ring.dropped_events());
+        Assert::AreEqual(ring_buffer::capacity, ring.drain([](const event*, size_t) {}));
+        Assert::IsTrue(ring.push(event{}));
+    }
+};
+
+TEST_CLASS(trace_session_test)
+{
+public:
+
+    TEST_METHOD(records_spans_from_all_threads)
+    {
+        const auto path = temporary_trace_path("win64_trace_test.bin");
+        constexpr int thread_count = 4;
+        constexpr int iterations = 1000;
+
+        {
+            session s{ path, chrono::milliseconds{ 1 } };
+
+            vector<thread> threads;
+            for (int i = 0; i < thread_count; ++i)
+            {
+                threads.emplace_back([]
+                {
+                    for (int n = 0; n < iterations; ++n)
+                    {
+                        traced_work(n);
+                    }
+                });
+            }
+
+            for (auto& t : threads)
+            {
+                t.join();
+            }
+        }
+
+        const auto events = read_file(path);
+        remove(path.c_str());
+
+        Assert::AreEqual(size_t{ thread_count * iterations * 3 }, events.size());
+
+        // Spans nest properly on each thread, and timestamps never go backwards.
+        map<uint32_t, int> depth;
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            const auto& d = events[i];
+            if (d.e.kind == event_kind::begin)
+            {
+                ++depth[d.thread];
+            }
+            else if (d.e.kind == event_kind::end)
+            {
+                Assert::IsTrue(--depth[d.thread] >= 0);
+            }
+
+            Assert::IsTrue(i == 0 || events[i - 1].e.timestamp <= d.e.timestamp);
+        }
+
+        Assert::AreEqual(size_t{ thread_count }, depth.size());
+    }
+
+    TEST_METHOD(ignores_events_outside_a_session)
+    {
+        traced_work(1);
+
+        const auto path = temporary_trace_path("win64_trace_empty.bin");
+        {
+            session s{ path };
+        }
+        traced_work(2);
+
+        const auto events = read_file(path);
+        remove(path.c_str());
+
+        Assert::AreEqual(size_t{ 0 }, events.size());
+    }
+
+    TEST_METHOD(second_session_leaves_the_first_alone)
+    {
+        const auto path = temporary_trace_path("win64_trace_second.bin");
+        const auto missing = (filesystem::temp_directory_path() / "win64_trace_missing" / "trace.bin").string();
+
+        // A session that fails to open its file does not keep the next one from starting.
+        Assert::ExpectException<runtime_error>([&] { session s{ missing }; });
+
+        {
+            session s{ path };
+            traced_work(1);
+
+            Assert::ExpectException<logic_error>([&] { session second{ path }; });
+            traced_work(2);
+        }
+
+        const auto events = read_file(path);
+        remove(path.c_str());
+
+        // Three events for each call, including the ones recorded before the second session was refused.
+        Assert::AreEqual(size_t{ 6 }, events.size());
+    }
+
+    TEST_METHOD(decodes_to_text_and_chrome_json)
+    {
+        const vector<decoded_event> events{
+            { 7, event{ 1000, static_cast<uint32_t>(event_id::ktm_transact), event_kind::begin, 0 } },
+            { 7, event{ 3000, static_cast<uint32_t>(event_id::ktm_transact), event_kind::end, 0 } },
+            { 7, event{ 4000, static_cast<uint32_t>(event_id::user) + 5, event_kind::instant, 42 } }
+        };
+
+        ostringstream text;
+        write_text(text, events);
+        Assert::IsTrue(text.str().find("2 us\tthread 7\tend\tktm::transact") != string::npos);
+        Assert::IsTrue(text.str().find("event 65541\tpayload 42") != string::npos);
+
+        ostringstream json;
+        write_chrome_json(json, events);
+        Assert::IsTrue(json.str().find("{\"name\":\"ktm::transact\",\"ph\":\"B\",\"ts\":0,\"pid\":1,\"tid\":7") != string::npos);
+        Assert::IsTrue(json.str().find("\"ph\":\"i\"") != string::npos);
+    }
+
+    TEST_METHOD(rejects_other_files)
+    {
+        istringstream input{ "not a trace" };
+        Assert::ExpectException<runtime_error>([&] { read(input); });
+    }
+};
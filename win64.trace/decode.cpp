@@ -0,0 +1,48 @@
+// Decodes a trace file written by `windows::trace::session`.
+//
+//     win64.trace <trace file>            one line of text per event
+//     win64.trace --chrome <trace file>   Chrome trace event JSON, for chrome://tracing or Perfetto
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+
+#include "win64/trace.hpp"
+
+int main(int argc, char** argv)
+{
+    const bool chrome = argc == 3 && std::strcmp(argv[1], "--chrome") == 0;
+    if (argc != 2 && !chrome)
+    {
+        std::fprintf(stderr, "usage: %s [--chrome] <trace file>\n", argv[0]);
+        return 2;
+    }
+
+    try
+    {
+        std::ifstream input{ argv[argc - 1], std::ios::binary };
+        if (!input)
+        {
+            std::fprintf(stderr, "cannot open %s\n", argv[argc - 1]);
+            return 1;
+        }
+
+        const auto events = windows::trace::read(input);
+
+        if (chrome)
+        {
+            windows::trace::write_chrome_json(std::cout, events);
+        }
+        else
+        {
+            windows::trace::write_text(std::cout, events);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+}
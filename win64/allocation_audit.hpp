@@ -0,0 +1,264 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+//! Allocation auditing.
+//!
+//! `scoped_allocation_counter` counts the heap allocations made by the calling thread while it is alive,
+//! so that tests can give each API an allocation budget, such as none on its success path.
+//! The counts come from replacements for the global `operator new` and `operator delete`, which are only
+//! compiled into the translation unit that defines `WIN64_ALLOCATION_AUDIT` before including this header.
+//! Define it in exactly one translation unit of the program. Without it, nothing is counted and `enabled` is false.
+//! Memory from `malloc` and from the operating system is not counted.
+
+namespace windows
+{
+    namespace allocation_audit
+    {
+        //! Allocations made by one thread.
+        struct allocation_counts
+        {
+            unsigned long long allocations; //!< Calls to `operator new`
+            unsigned long long deallocations; //!< Calls to `operator delete` with a non-null pointer
+            unsigned long long bytes; //!< Bytes requested from `operator new`
+        };
+
+        inline allocation_counts operator-(const allocation_counts& a, const allocation_counts& b)
+        {
+            return allocation_counts{ a.allocations - b.allocations, a.deallocations - b.deallocations, a.bytes - b.bytes };
+        }
+
+        namespace detail
+        {
+            inline thread_local allocation_counts counts{ 0, 0, 0 };
+
+            //! Set during static initialization by the translation unit that defines the replacements.
+            inline bool interposed = false;
+
+            inline void record_allocation(std::size_t size) noexcept
+            {
+                ++counts.allocations;
+                counts.bytes += size;
+            }
+
+            inline void record_deallocation(void* block) noexcept
+            {
+                if (block != nullptr)
+                {
+                    ++counts.deallocations;
+                }
+            }
+        }
+
+        //! Whether the global allocator has been replaced with one that counts.
+        inline bool enabled() noexcept
+        {
+            return detail::interposed;
+        }
+
+        //! Counts the allocations the calling thread makes from its construction until `counts` is called.
+        //! Counters nest: each only sees the allocations made while it exists.
+        class scoped_allocation_counter
+        {
+        public:
+            scoped_allocation_counter() noexcept :
+                start{ detail::counts }
+            {
+            }
+
+            scoped_allocation_counter(const scoped_allocation_counter&) = delete;
+            scoped_allocation_counter& operator=(const scoped_allocation_counter&) = delete;
+
+            allocation_counts counts() const noexcept
+            {
+                return detail::counts - start;
+            }
+
+            unsigned long long allocations() const noexcept
+            {
+                return counts().allocations;
+            }
+
+            unsigned long long bytes() const noexcept
+            {
+                return counts().bytes;
+            }
+
+        private:
+            const allocation_counts start;
+        };
+
+        //! The allocations made by the calling thread while calling `function`.
+        template <typename Function>
+        allocation_counts count_allocations(Function&& function)
+        {
+            const scoped_allocation_counter counter;
+            function();
+            return counter.counts();
+        }
+    }
+}
+
+#if defined(WIN64_ALLOCATION_AUDIT)
+
+// The replacements. The array forms are replaced too, although by default they call the others,
+// since sanitizers replace them separately.
+
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC sees `free` being called on memory from `operator new` once the replacements are inlined.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace windows
+{
+    namespace allocation_audit
+    {
+        namespace detail
+        {
+            inline void* allocate(std::size_t size) noexcept
+            {
+                record_allocation(size);
+                return std::malloc(size == 0 ? 1 : size);
+            }
+
+            inline void* allocate(std::size_t size, std::align_val_t alignment) noexcept
+            {
+                record_allocation(size);
+                const auto align = static_cast<std::size_t>(alignment);
+#if defined(_WIN32)
+                return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+                // `aligned_alloc` wants a non-zero multiple of the alignment.
+                return std::aligned_alloc(align, size == 0 ? align : (size + align - 1) / align * align);
+#endif
+            }
+
+            inline void deallocate(void* block) noexcept
+            {
+                record_deallocation(block);
+                std::free(block);
+            }
+
+            inline void deallocate(void* block, std::align_val_t) noexcept
+            {
+                record_deallocation(block);
+#if defined(_WIN32)
+                _aligned_free(block);
+#else
+                std::free(block);
+#endif
+            }
+
+            static const bool interposing = (interposed = true);
+        }
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    if (const auto block = windows::allocation_audit::detail::allocate(size))
+    {
+        return block;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return windows::allocation_audit::detail::allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (const auto block = windows::allocation_audit::detail::allocate(size, alignment))
+    {
+        return block;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return windows::allocation_audit::detail::allocate(size, alignment);
+}
+
+void operator delete(void* block) noexcept
+{
+    windows::allocation_audit::detail::deallocate(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept
+{
+    windows::allocation_audit::detail::deallocate(block);
+}
+
+void operator delete(void* block, std::align_val_t alignment) noexcept
+{
+    windows::allocation_audit::detail::deallocate(block, alignment);
+}
+
+void operator delete(void* block, std::size_t, std::align_val_t alignment) noexcept
+{
+    windows::allocation_audit::detail::deallocate(block, alignment);
+}
+
+void* operator new[](std::size_t size)
+{
+    if (const auto block = windows::allocation_audit::detail::allocate(size))
+    {
+        return block;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return windows::allocation_audit::detail::allocate(size);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    if (const auto block = windows::allocation_audit::detail::allocate(size, alignment))
+    {
+        return block;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return windows::allocation_audit::detail::allocate(size, alignment);
+}
+
+void operator delete[](void* block) noexcept
+{
+    windows::allocation_audit::detail::deallocate(block);
+}
+
+void operator delete[](void* block, std::size_t) noexcept
+{
+    windows::allocation_audit::detail::deallocate(block);
+}
+
+void operator delete[](void* block, std::align_val_t alignment) noexcept
+{
+    windows::allocation_audit::detail::deallocate(block, alignment);
+}
+
+void operator delete[](void* block, std::size_t, std::align_val_t alignment) noexcept
+{
+    windows::allocation_audit::detail::deallocate(block, alignment);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace windows
+{
+    namespace memory
+    {
+        //! A monotonic arena for short-lived allocations, such as the temporaries of a bulk registration.
+        //! The first `InlineSize` bytes come from a buffer inside the arena; after that, the arena takes
+        //! geometrically growing blocks from `upstream`. Deallocation is a no-op; everything is released at once
+        //! when the arena is destroyed or `release` is called.
+        //! Pass the arena to `std::pmr` containers, `windows::pmr::path` and the `pmr` conversion functions.
+        //! It does not replace the default resource, so only allocations that are given the arena use it.
+        //! Not thread-safe.
+        template <std::size_t InlineSize = 4096>
+        class scoped_arena
+        {
+        public:
+            explicit scoped_arena(std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) :
+                resource{ buffer, InlineSize, upstream }
+            {
+            }
+
+            scoped_arena(const scoped_arena&) = delete;
+            scoped_arena& operator=(const scoped_arena&) = delete;
+
+            std::pmr::memory_resource* get() noexcept
+            {
+                return &resource;
+            }
+
+            operator std::pmr::memory_resource*() noexcept
+            {
+                return get();
+            }
+
+            //! An allocator for `T` that allocates from the arena.
+            template <typename T = std::byte>
+            std::pmr::polymorphic_allocator<T> allocator() noexcept
+            {
+                return std::pmr::polymorphic_allocator<T>{ get() };
+            }
+
+            //! Free everything allocated from the arena. Objects still using its memory must already be destroyed.
+            void release()
+            {
+                resource.release();
+            }
+
+        private:
+            alignas(std::max_align_t) std::byte buffer[InlineSize];
+            std::pmr::monotonic_buffer_resource resource; //!< Declared after `buffer`, which it uses
+        };
+    }
+}
\ No newline at end of file
@@ -0,0 +1,405 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WIN64_CASE_INSENSITIVE_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "path.hpp"
+#include "uppercase_table.hpp"
+
+namespace windows
+{
+    //! Ordinal case-insensitive comparison of UTF-16 strings, as the registry and NTFS compare names:
+    //! each code unit is mapped through a simple uppercase table and the results are compared by value.
+    //! Where `wchar_t` is 32 bits, code units above U+FFFF are compared as-is.
+    namespace case_insensitive
+    {
+        namespace detail
+        {
+            template <typename CharT>
+            constexpr CharT to_upper(CharT c) noexcept
+            {
+                const auto u = static_cast<std::make_unsigned_t<CharT>>(c);
+                if (u < 0x80)
+                {
+                    return u >= 'a' && u <= 'z' ? static_cast<CharT>(u - 0x20) : c;
+                }
+                else if (u > 0xFFFF)
+                {
+                    return c;
+                }
+
+                const auto page = uppercase_page_index[u >> 8];
+                return page == 0 ? c : static_cast<CharT>(uppercase_pages[page - 1][u & 0xFF]);
+            }
+
+            template <typename CharT>
+            constexpr auto upper_value(CharT c) noexcept
+            {
+                return static_cast<std::make_unsigned_t<CharT>>(to_upper(c));
+            }
+
+            //! Code units per vector step.
+            constexpr std::size_t block = 8;
+
+#if defined(__GNUC__) && !defined(__clang__)
+            // GCC warns about the vector loads in branches that constant short inputs never take.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#endif
+
+#if defined(WIN64_CASE_INSENSITIVE_SSE2)
+            //! Subtract 0x20 from the 16-bit lanes that hold 'a'-'z'.
+            inline __m128i fold_ascii_16(__m128i x)
+            {
+                const auto lower = _mm_and_si128(_mm_cmpgt_epi16(x, _mm_set1_epi16('a' - 1)), _mm_cmpgt_epi16(_mm_set1_epi16('z' + 1), x));
+                return _mm_sub_epi16(x, _mm_and_si128(lower, _mm_set1_epi16(0x20)));
+            }
+
+            //! Subtract 0x20 from the 32-bit lanes that hold 'a'-'z'.
+            inline __m128i fold_ascii_32(__m128i x)
+            {
+                const auto lower = _mm_and_si128(_mm_cmpgt_epi32(x, _mm_set1_epi32('a' - 1)), _mm_cmpgt_epi32(_mm_set1_epi32('z' + 1), x));
+                return _mm_sub_epi32(x, _mm_and_si128(lower, _mm_set1_epi32(0x20)));
+            }
+
+            inline __m128i load(const void* p)
+            {
+                return _mm_loadu_si128(static_cast<const __m128i*>(p));
+            }
+
+            //! Whether a block of code units is equal after folding the case of ASCII letters.
+            //! If so, the block is equal after uppercasing too; if not, it needs the full table to decide.
+            template <typename CharT>
+            bool block_equal_ascii(const CharT* a, const CharT* b)
+            {
+                if constexpr (sizeof(CharT) == 2)
+                {
+                    const auto x = load(a);
+                    const auto y = load(b);
+                    return _mm_movemask_epi8(_mm_cmpeq_epi16(x, y)) == 0xFFFF
+                        || _mm_movemask_epi8(_mm_cmpeq_epi16(fold_ascii_16(x), fold_ascii_16(y))) == 0xFFFF;
+                }
+                else
+                {
+                    const auto low = _mm_cmpeq_epi32(fold_ascii_32(load(a)), fold_ascii_32(load(b)));
+                    const auto high = _mm_cmpeq_epi32(fold_ascii_32(load(a + 4)), fold_ascii_32(load(b + 4)));
+                    return _mm_movemask_epi8(_mm_and_si128(low, high)) == 0xFFFF;
+                }
+            }
+
+            //! Uppercase a block of ASCII code units into 16-bit lanes. Returns false if any of them is not ASCII.
+            template <typename CharT>
+            bool upper_block_ascii(const CharT* p, __m128i& units)
+            {
+                if constexpr (sizeof(CharT) == 2)
+                {
+                    const auto x = load(p);
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(x, _mm_set1_epi16(static_cast<short>(0xFF80))), _mm_setzero_si128())) != 0xFFFF)
+                    {
+                        return false;
+                    }
+
+                    units = fold_ascii_16(x);
+                    return true;
+                }
+                else
+                {
+                    const auto low = load(p);
+                    const auto high = load(p + 4);
+                    const auto non_ascii = _mm_and_si128(_mm_or_si128(low, high), _mm_set1_epi32(~0x7F));
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi32(non_ascii, _mm_setzero_si128())) != 0xFFFF)
+                    {
+                        return false;
+                    }
+
+                    units = fold_ascii_16(_mm_packs_epi32(low, high));
+                    return true;
+                }
+            }
+#endif
+
+            template <typename CharT>
+            bool block_equal(const CharT* a, const CharT* b, std::size_t n)
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    if (to_upper(a[i]) != to_upper(b[i]))
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            template <typename CharT>
+            bool equal(std::basic_string_view<CharT> a, std::basic_string_view<CharT> b)
+            {
+                if (a.size() != b.size())
+                {
+                    return false;
+                }
+
+                std::size_t i = 0;
+#if defined(WIN64_CASE_INSENSITIVE_SSE2)
+                for (; i + block <= a.size(); i += block)
+                {
+                    if (!block_equal_ascii(a.data() + i, b.data() + i) && !block_equal(a.data() + i, b.data() + i, block))
+                    {
+                        return false;
+                    }
+                }
+#endif
+                return block_equal(a.data() + i, b.data() + i, a.size() - i);
+            }
+
+            //! Compare `n` code units. Returns true and sets `result` at the first difference.
+            template <typename CharT>
+            bool block_compare(const CharT* a, const CharT* b, std::size_t n, int& result)
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    const auto x = upper_value(a[i]);
+                    const auto y = upper_value(b[i]);
+                    if (x != y)
+                    {
+                        result = x < y ? -1 : 1;
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+
+            template <typename CharT>
+            int compare(std::basic_string_view<CharT> a, std::basic_string_view<CharT> b)
+            {
+                const auto n = a.size() < b.size() ? a.size() : b.size();
+                int result = 0;
+                std::size_t i = 0;
+#if defined(WIN64_CASE_INSENSITIVE_SSE2)
+                for (; i + block <= n; i += block)
+                {
+                    if (!block_equal_ascii(a.data() + i, b.data() + i) && block_compare(a.data() + i, b.data() + i, block, result))
+                    {
+                        return result;
+                    }
+                }
+#endif
+                if (block_compare(a.data() + i, b.data() + i, n - i, result))
+                {
+                    return result;
+                }
+
+                return a.size() == b.size() ? 0 : (a.size() < b.size() ? -1 : 1);
+            }
+
+            inline std::uint64_t mix(std::uint64_t h, std::uint64_t word)
+            {
+                return (((h << 5) | (h >> 59)) ^ word) * 0x517CC1B727220A95ull;
+            }
+
+            //! Hash the uppercase code units, truncated to 16 bits, 8 at a time.
+            template <typename CharT>
+            std::size_t hash_value(std::basic_string_view<CharT> s)
+            {
+                std::uint64_t h = 0;
+                std::uint16_t units[block];
+                std::uint64_t words[2];
+
+                for (std::size_t i = 0; i < s.size(); i += block)
+                {
+                    const auto count = s.size() - i < block ? s.size() - i : block;
+#if defined(WIN64_CASE_INSENSITIVE_SSE2)
+                    __m128i folded;
+                    if (count == block && upper_block_ascii(s.data() + i, folded))
+                    {
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(units), folded);
+                    }
+                    else
+#endif
+                    {
+                        for (std::size_t j = 0; j < block; ++j)
+                        {
+                            units[j] = j < count ? static_cast<std::uint16_t>(upper_value(s[i + j])) : 0;
+                        }
+                    }
+
+                    std::memcpy(words, units, sizeof(words));
+                    h = mix(mix(h, words[0]), words[1]);
+                }
+
+                // Finish with the MurmurHash3 finalizer so that every bit of the input affects the low bits.
+                h ^= s.size();
+                h = (h ^ (h >> 33)) * 0xFF51AFD7ED558CCDull;
+                h = (h ^ (h >> 33)) * 0xC4CEB9FE1A85EC53ull;
+                return static_cast<std::size_t>(h ^ (h >> 33));
+            }
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+        }
+
+        //! Uppercase one code unit.
+        constexpr wchar_t to_upper(wchar_t c) noexcept
+        {
+            return detail::to_upper(c);
+        }
+
+        constexpr char16_t to_upper(char16_t c) noexcept
+        {
+            return detail::to_upper(c);
+        }
+
+        inline bool equal(std::wstring_view a, std::wstring_view b)
+        {
+            return detail::equal(a, b);
+        }
+
+        inline bool equal(std::u16string_view a, std::u16string_view b)
+        {
+            return detail::equal(a, b);
+        }
+
+        //! Returns a negative number, zero or a positive number as `a` orders before, the same as or after `b`.
+        inline int compare(std::wstring_view a, std::wstring_view b)
+        {
+            return detail::compare(a, b);
+        }
+
+        inline int compare(std::u16string_view a, std::u16string_view b)
+        {
+            return detail::compare(a, b);
+        }
+
+        //! A hash that is equal for strings that are `equal`.
+        inline std::size_t hash_value(std::wstring_view s)
+        {
+            return detail::hash_value(s);
+        }
+
+        inline std::size_t hash_value(std::u16string_view s)
+        {
+            return detail::hash_value(s);
+        }
+
+        //! Function objects for containers of strings keyed without regard to case, such as
+        //! `std::unordered_map<std::wstring, T, case_insensitive::hash, case_insensitive::equal_to>`.
+        struct equal_to
+        {
+            bool operator()(std::wstring_view a, std::wstring_view b) const
+            {
+                return equal(a, b);
+            }
+
+            bool operator()(std::u16string_view a, std::u16string_view b) const
+            {
+                return equal(a, b);
+            }
+        };
+
+        struct less
+        {
+            using is_transparent = void;
+
+            bool operator()(std::wstring_view a, std::wstring_view b) const
+            {
+                return compare(a, b) < 0;
+            }
+
+            bool operator()(std::u16string_view a, std::u16string_view b) const
+            {
+                return compare(a, b) < 0;
+            }
+        };
+
+        struct hash
+        {
+            std::size_t operator()(std::wstring_view s) const
+            {
+                return hash_value(s);
+            }
+
+            std::size_t operator()(std::u16string_view s) const
+            {
+                return hash_value(s);
+            }
+        };
+    }
+
+    //! A strongly typed, immutable path that compares, orders and hashes without regard to case,
+    //! like registry keys. The hash is computed once, so hash maps keyed by the path never rehash it.
+    class case_insensitive_path
+    {
+    public:
+        case_insensitive_path(std::wstring str) :
+            str{ std::move(str) },
+            hash{ case_insensitive::hash_value(this->str) }
+        {
+        }
+
+        case_insensitive_path(const path& path) :
+            case_insensitive_path{ path.str }
+        {
+        }
+
+        case_insensitive_path(const case_insensitive_path&) = default;
+        case_insensitive_path(case_insensitive_path&&) = default;
+
+        case_insensitive_path& operator=(const case_insensitive_path&) = delete;
+        case_insensitive_path& operator=(case_insensitive_path&&) = delete;
+
+        const wchar_t* c_str() const
+        {
+            return str.c_str();
+        }
+
+    public:
+        const std::wstring str;
+        const std::size_t hash;
+    };
+
+    inline bool operator==(const case_insensitive_path& a, const case_insensitive_path& b)
+    {
+        return a.hash == b.hash && case_insensitive::equal(a.str, b.str);
+    }
+
+    inline bool operator!=(const case_insensitive_path& a, const case_insensitive_path& b)
+    {
+        return !(a == b);
+    }
+
+    inline bool operator<(const case_insensitive_path& a, const case_insensitive_path& b)
+    {
+        return case_insensitive::compare(a.str, b.str) < 0;
+    }
+
+    inline case_insensitive_path operator/(const case_insensitive_path& path, const std::wstring& str)
+    {
+        return path.str + L"\\" + str;
+    }
+}
+
+namespace std
+{
+    template <>
+    struct hash<windows::case_insensitive_path>
+    {
+        size_t operator()(const windows::case_insensitive_path& path) const noexcept
+        {
+            return path.hash;
+        }
+    };
+}
\ No newline at end of file
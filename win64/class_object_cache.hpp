@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace windows
+{
+    namespace com
+    {
+        //! Per-thread cache of class objects, so that repeated activations of the same class
+        //! skip the class table lookup and the creation of a new class object.
+        //!
+        //! `Traits` provides the activation layer:
+        //! - `key_type`, which identifies a class and is compared with `==` (for example, `CLSID`)
+        //! - `pointer`, an owning smart pointer to a class object (for example, `ComPtr<IClassFactory>`)
+        //! - `static pointer get_class_object(const key_type&, unsigned long class_context)`, which throws on failure
+        //!
+        //! Each thread has its own cache, so a class object is only ever used on the thread (and so the apartment) that created it.
+        //! Class objects must be released before the thread leaves its apartment: call `flush` before `CoUninitialize`.
+        template <typename Traits>
+        class class_object_cache
+        {
+        public:
+            using key_type = typename Traits::key_type;
+            using pointer = typename Traits::pointer;
+
+            class_object_cache() = delete;
+
+            //! Get the class object for `key` from the calling thread's cache.
+            //! On a miss, the class object is activated through `Traits::get_class_object` and cached.
+            static pointer get(const key_type& key, unsigned long class_context)
+            {
+                auto& cache = local_cache();
+                cache.synchronize();
+
+                const auto it = std::find_if(cache.entries.begin(), cache.entries.end(), [&](const entry& e)
+                {
+                    return e.class_context == class_context && e.key == key;
+                });
+
+                if (it != cache.entries.end())
+                {
+                    return it->class_object;
+                }
+                else
+                {
+                    auto class_object = Traits::get_class_object(key, class_context);
+                    cache.entries.push_back(entry{ key, class_context, class_object });
+                    return class_object;
+                }
+            }
+
+            //! Release all class objects cached by the calling thread.
+            static void flush()
+            {
+                auto& cache = local_cache();
+                cache.entries.clear();
+                cache.generation = generation().load(std::memory_order_acquire);
+            }
+
+            //! Invalidate the caches of all threads.
+            //! The calling thread's class objects are released immediately.
+            //! Other threads release theirs on their next call to `get` or `flush`,
+            //! since a class object may only be released in the apartment that created it.
+            static void flush_all()
+            {
+                generation().fetch_add(1, std::memory_order_acq_rel);
+                flush();
+            }
+
+            //! The number of class objects cached by the calling thread.
+            static std::size_t size()
+            {
+                auto& cache = local_cache();
+                cache.synchronize();
+                return cache.entries.size();
+            }
+
+        private:
+            struct entry
+            {
+                key_type key;
+                unsigned long class_context;
+                pointer class_object;
+            };
+
+            struct thread_cache
+            {
+                std::vector<entry> entries;
+                unsigned long long generation = class_object_cache::generation().load(std::memory_order_acquire);
+
+                //! Drop the entries if `flush_all` has been called since this cache was last used.
+                void synchronize()
+                {
+                    const auto current = class_object_cache::generation().load(std::memory_order_acquire);
+                    if (generation != current)
+                    {
+                        entries.clear();
+                        generation = current;
+                    }
+                }
+            };
+
+            static std::atomic<unsigned long long>& generation()
+            {
+                static std::atomic<unsigned long long> value{ 0 };
+                return value;
+            }
+
+            static thread_cache& local_cache()
+            {
+                thread_local thread_cache cache;
+                return cache;
+            }
+        };
+    }
+}
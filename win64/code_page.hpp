@@ -0,0 +1,575 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WIN64_CODE_PAGE_SSE2
+#include <emmintrin.h>
+#endif
+
+// The gather kernel for non-ASCII bytes is opt-in: it is only compiled when the compiler targets AVX2
+// (`-mavx2`, `/arch:AVX2`, or `WIN64_ENABLE_AVX2` in CMake). Other builds decode those bytes one at a time.
+#if defined(__AVX2__)
+#define WIN64_CODE_PAGE_AVX2
+#include <immintrin.h>
+#endif
+
+#include "code_page_tables.hpp"
+#include "unicode.hpp"
+
+namespace windows
+{
+    namespace locale
+    {
+        //! Single-byte code pages with built-in converters.
+        enum class code_page
+        {
+            windows_1252 = 1252, //!< Western European (Windows)
+            windows_1251 = 1251, //!< Cyrillic (Windows)
+            oem_437 = 437 //!< OEM United States
+        };
+
+        //! How converters handle bytes that a code page does not define and characters it cannot represent.
+        //! The mappings are the Unicode.org tables, so the bytes that Windows maps by "best fit"
+        //! (for example, 0x81 in code page 1252) are undefined.
+        enum class conversion_mode
+        {
+            strict, //!< Throw `std::range_error`
+            lossy //!< Replace with U+FFFD when decoding and with '?' when encoding
+        };
+
+        namespace detail
+        {
+            constexpr std::uint16_t undefined = 0xFFFF;
+            constexpr char32_t replacement_character = 0xFFFD;
+            constexpr char substitute_byte = '?';
+
+            [[noreturn]] inline void throw_unsupported(code_page cp)
+            {
+                throw std::invalid_argument{ "unsupported code page " + std::to_string(static_cast<int>(cp)) };
+            }
+
+            inline const code_page_table& table(code_page cp)
+            {
+                switch (cp)
+                {
+                case code_page::windows_1252: return windows_1252_table;
+                case code_page::windows_1251: return windows_1251_table;
+                case code_page::oem_437: return oem_437_table;
+                default: throw_unsupported(cp);
+                }
+            }
+
+            //! Conversion tables derived from a `code_page_table` on first use.
+            struct derived_table
+            {
+                //! `to_unicode` widened to 32 bits for the gather kernel: as-is for strict mode,
+                //! and with undefined bytes replaced by U+FFFD for lossy mode.
+                std::uint32_t strict[256];
+                std::uint32_t lossy[256];
+
+                //! UTF-8 encoding of each byte, with undefined bytes encoded as U+FFFD.
+                unsigned char utf8_length[256];
+                char utf8[256][3];
+
+                explicit derived_table(const code_page_table& t)
+                {
+                    for (int b = 0; b < 256; ++b)
+                    {
+                        const auto c = t.to_unicode[b];
+                        strict[b] = c;
+                        lossy[b] = c == undefined ? replacement_character : c;
+
+                        const auto u = lossy[b];
+                        if (u < 0x80)
+                        {
+                            utf8_length[b] = 1;
+                            utf8[b][0] = static_cast<char>(u);
+                        }
+                        else if (u < 0x800)
+                        {
+                            utf8_length[b] = 2;
+                            utf8[b][0] = static_cast<char>(0xC0 | (u >> 6));
+                            utf8[b][1] = static_cast<char>(0x80 | (u & 0x3F));
+                        }
+                        else
+                        {
+                            utf8_length[b] = 3;
+                            utf8[b][0] = static_cast<char>(0xE0 | (u >> 12));
+                            utf8[b][1] = static_cast<char>(0x80 | ((u >> 6) & 0x3F));
+                            utf8[b][2] = static_cast<char>(0x80 | (u & 0x3F));
+                        }
+                    }
+                }
+            };
+
+            inline const derived_table& derived(code_page cp)
+            {
+                static const derived_table windows_1252{ windows_1252_table };
+                static const derived_table windows_1251{ windows_1251_table };
+                static const derived_table oem_437{ oem_437_table };
+
+                switch (cp)
+                {
+                case code_page::windows_1252: return windows_1252;
+                case code_page::windows_1251: return windows_1251;
+                case code_page::oem_437: return oem_437;
+                default: throw_unsupported(cp);
+                }
+            }
+
+            [[noreturn]] inline void throw_undefined_byte(code_page cp, unsigned char byte, std::size_t offset)
+            {
+                throw std::range_error{ "byte " + std::to_string(byte) + " at offset " + std::to_string(offset)
+                    + " is not defined in code page " + std::to_string(static_cast<int>(cp)) };
+            }
+
+            [[noreturn]] inline void throw_unmappable(code_page cp, char32_t c, std::size_t offset)
+            {
+                throw std::range_error{ "character U+" + std::to_string(static_cast<unsigned long>(c)) + " at offset " + std::to_string(offset)
+                    + " cannot be represented in code page " + std::to_string(static_cast<int>(cp)) };
+            }
+
+            //! Byte for a character, or 0 if the code page cannot represent it.
+            inline unsigned char lookup(const code_page_table& t, char32_t c)
+            {
+                if (c < 0x80)
+                {
+                    return static_cast<unsigned char>(c);
+                }
+                else if (c > 0xFFFF)
+                {
+                    return 0;
+                }
+
+                const auto page = t.page_index[c >> 8];
+                return page == 0 ? 0 : t.pages[page - 1][c & 0xFF];
+            }
+
+#if defined(__GNUC__) && !defined(__clang__)
+            // GCC warns about the vector loads in branches that constant short inputs never take.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#endif
+
+#if defined(WIN64_CODE_PAGE_SSE2)
+            //! Widen 16 ASCII bytes to 16- or 32-bit code units.
+            template <typename CharT>
+            void store_widened(__m128i bytes, CharT* out)
+            {
+                const auto zero = _mm_setzero_si128();
+                const auto low = _mm_unpacklo_epi8(bytes, zero);
+                const auto high = _mm_unpackhi_epi8(bytes, zero);
+
+                if constexpr (sizeof(CharT) == 2)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), low);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), high);
+                }
+                else
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi16(low, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_unpackhi_epi16(low, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpacklo_epi16(high, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm_unpackhi_epi16(high, zero));
+                }
+            }
+
+            //! Load 16 code units and narrow them to bytes. Returns false if any of them is not ASCII.
+            template <typename CharT>
+            bool load_narrowed(const CharT* in, __m128i& bytes)
+            {
+                if constexpr (sizeof(CharT) == 2)
+                {
+                    const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+                    const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 8));
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16(static_cast<short>(0xFF80))), _mm_setzero_si128())) != 0xFFFF)
+                    {
+                        return false;
+                    }
+
+                    bytes = _mm_packus_epi16(a, b);
+                    return true;
+                }
+                else
+                {
+                    const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+                    const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 4));
+                    const auto c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 8));
+                    const auto d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 12));
+                    const auto any = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(any, _mm_set1_epi32(~0x7F)), _mm_setzero_si128())) != 0xFFFF)
+                    {
+                        return false;
+                    }
+
+                    bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+                    return true;
+                }
+            }
+#endif
+
+            //! Decode one byte without vector instructions.
+            template <typename CharT>
+            void decode_byte(code_page cp, const std::uint32_t* to_unicode, const unsigned char* in, std::size_t i, CharT* out)
+            {
+                const auto c = to_unicode[in[i]];
+                if (c == undefined)
+                {
+                    throw_undefined_byte(cp, in[i], i);
+                }
+                out[i] = static_cast<CharT>(c);
+            }
+
+            //! Decode `n` bytes into `n` code units of `out`.
+            //! Runs of ASCII are widened 16 bytes at a time; in AVX2 builds only, other bytes are looked up 8 at a time with a gather.
+            template <typename CharT>
+            void decode(code_page cp, const unsigned char* in, std::size_t n, CharT* out, conversion_mode mode)
+            {
+                const auto& d = derived(cp);
+                const auto to_unicode = mode == conversion_mode::strict ? d.strict : d.lossy;
+                std::size_t i = 0;
+
+#if defined(WIN64_CODE_PAGE_SSE2)
+                while (i + 16 <= n)
+                {
+                    const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                    if (_mm_movemask_epi8(bytes) == 0)
+                    {
+                        store_widened(bytes, out + i);
+                        i += 16;
+                        continue;
+                    }
+
+                    const auto end = i + 16;
+                    for (; i < end; i += 8)
+                    {
+#if defined(WIN64_CODE_PAGE_AVX2)
+                        const auto indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i)));
+                        const auto chars = _mm256_i32gather_epi32(reinterpret_cast<const int*>(to_unicode), indices, 4);
+
+                        if (mode == conversion_mode::lossy
+                            || _mm256_movemask_epi8(_mm256_cmpeq_epi32(chars, _mm256_set1_epi32(undefined))) == 0)
+                        {
+                            if constexpr (sizeof(CharT) == 2)
+                            {
+                                const auto packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(chars, chars), 0x08);
+                                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_castsi256_si128(packed));
+                            }
+                            else
+                            {
+                                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), chars);
+                            }
+                            continue;
+                        }
+#endif
+                        for (std::size_t j = i; j < i + 8; ++j)
+                        {
+                            decode_byte(cp, to_unicode, in, j, out);
+                        }
+                    }
+                }
+#endif
+
+                for (; i < n; ++i)
+                {
+                    decode_byte(cp, to_unicode, in, i, out);
+                }
+            }
+
+            //! Encode UTF-16 (or UTF-32, where `wchar_t` is 32 bits) into `out`, which must have room for `n` bytes.
+            //! Returns the number of bytes written, which is less than `n` only when surrogate pairs were replaced.
+            template <typename CharT>
+            std::size_t encode(code_page cp, const CharT* in, std::size_t n, char* out, conversion_mode mode)
+            {
+                const auto& t = table(cp);
+                std::size_t i = 0;
+                std::size_t o = 0;
+
+                while (i < n)
+                {
+#if defined(WIN64_CODE_PAGE_SSE2)
+                    __m128i bytes;
+                    if (i + 16 <= n && load_narrowed(in + i, bytes))
+                    {
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), bytes);
+                        i += 16;
+                        o += 16;
+                        continue;
+                    }
+#endif
+                    const auto end = i + 16 < n ? i + 16 : n;
+                    for (; i < end; ++i)
+                    {
+                        const auto c = static_cast<char32_t>(static_cast<std::make_unsigned_t<CharT>>(in[i]));
+                        const auto b = lookup(t, c);
+
+                        if (b != 0 || c == 0)
+                        {
+                            out[o++] = static_cast<char>(b);
+                        }
+                        else if (mode == conversion_mode::strict)
+                        {
+                            throw_unmappable(cp, c, i);
+                        }
+                        else
+                        {
+                            out[o++] = substitute_byte;
+
+                            // A surrogate pair is one character, so it gets one substitute.
+                            if (c >= 0xD800 && c < 0xDC00 && i + 1 < n && in[i + 1] >= 0xDC00 && in[i + 1] < 0xE000)
+                            {
+                                ++i;
+                            }
+                        }
+                    }
+                }
+
+                return o;
+            }
+
+            //! Append the UTF-8 encoding of `n` bytes to `output`.
+            inline void decode_to_utf8(code_page cp, const unsigned char* in, std::size_t n, std::string& output, conversion_mode mode)
+            {
+                const auto& d = derived(cp);
+                const auto start = output.size();
+                output.resize(start + 3 * n);
+                auto out = &output[start];
+                std::size_t i = 0;
+
+                while (i < n)
+                {
+#if defined(WIN64_CODE_PAGE_SSE2)
+                    if (i + 16 <= n)
+                    {
+                        const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                        if (_mm_movemask_epi8(bytes) == 0)
+                        {
+                            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), bytes);
+                            i += 16;
+                            out += 16;
+                            continue;
+                        }
+                    }
+#endif
+                    const auto end = i + 16 < n ? i + 16 : n;
+                    for (; i < end; ++i)
+                    {
+                        const auto b = in[i];
+                        if (mode == conversion_mode::strict && d.strict[b] == undefined)
+                        {
+                            throw_undefined_byte(cp, b, i);
+                        }
+
+                        for (unsigned k = 0; k < d.utf8_length[b]; ++k)
+                        {
+                            *out++ = d.utf8[b][k];
+                        }
+                    }
+                }
+
+                output.resize(static_cast<std::size_t>(out - output.data()));
+            }
+
+            //! Append the encoding of UTF-8 text to `output`.
+            //! Returns the number of bytes consumed; unless `final`, an incomplete sequence at the end is left unconsumed.
+            inline std::size_t encode_from_utf8(code_page cp, const unsigned char* in, std::size_t n, std::string& output, conversion_mode mode, bool final)
+            {
+                const auto& t = table(cp);
+                const auto start = output.size();
+                output.resize(start + n);
+                auto out = &output[start];
+                std::size_t i = 0;
+
+                while (i < n)
+                {
+#if defined(WIN64_CODE_PAGE_SSE2)
+                    if (i + 16 <= n)
+                    {
+                        const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                        if (_mm_movemask_epi8(bytes) == 0)
+                        {
+                            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), bytes);
+                            i += 16;
+                            out += 16;
+                            continue;
+                        }
+                    }
+#endif
+                    char32_t c;
+                    const auto length = decode_utf8(in + i, in + n, c);
+
+                    if (length == 0 && !final)
+                    {
+                        break;
+                    }
+                    else if (length <= 0)
+                    {
+                        if (mode == conversion_mode::strict)
+                        {
+                            throw std::range_error{ "invalid UTF-8 at offset " + std::to_string(i) };
+                        }
+
+                        *out++ = substitute_byte;
+                        ++i;
+                        continue;
+                    }
+
+                    const auto b = lookup(t, c);
+                    if (b == 0 && c != 0)
+                    {
+                        if (mode == conversion_mode::strict)
+                        {
+                            throw_unmappable(cp, c, i);
+                        }
+
+                        *out++ = substitute_byte;
+                    }
+                    else
+                    {
+                        *out++ = static_cast<char>(b);
+                    }
+
+                    i += static_cast<std::size_t>(length);
+                }
+
+                output.resize(static_cast<std::size_t>(out - output.data()));
+                return i;
+            }
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+            template <typename String>
+            void append_decoded(code_page cp, std::string_view bytes, String& output, conversion_mode mode)
+            {
+                const auto start = output.size();
+                output.resize(start + bytes.size());
+                decode(cp, reinterpret_cast<const unsigned char*>(bytes.data()), bytes.size(), &output[start], mode);
+            }
+
+            template <typename CharT>
+            void append_encoded(code_page cp, std::basic_string_view<CharT> text, std::string& output, conversion_mode mode)
+            {
+                const auto start = output.size();
+                output.resize(start + text.size());
+                output.resize(start + encode(cp, text.data(), text.size(), &output[start], mode));
+            }
+        }
+
+        //! Convert text in a single-byte code page to UTF-16, appending to `output`.
+        //! The conversion is stateless, so a stream can be converted one chunk at a time.
+        inline void code_page_to_wide(code_page cp, std::string_view bytes, std::wstring& output, conversion_mode mode = conversion_mode::strict)
+        {
+            detail::append_decoded(cp, bytes, output, mode);
+        }
+
+        inline std::wstring code_page_to_wide(code_page cp, std::string_view bytes, conversion_mode mode = conversion_mode::strict)
+        {
+            std::wstring output;
+            code_page_to_wide(cp, bytes, output, mode);
+            return output;
+        }
+
+        //! Convert text in a single-byte code page to UTF-16, appending to `output`.
+        //! The conversion is stateless, so a stream can be converted one chunk at a time.
+        inline void code_page_to_utf16(code_page cp, std::string_view bytes, std::u16string& output, conversion_mode mode = conversion_mode::strict)
+        {
+            detail::append_decoded(cp, bytes, output, mode);
+        }
+
+        inline std::u16string code_page_to_utf16(code_page cp, std::string_view bytes, conversion_mode mode = conversion_mode::strict)
+        {
+            std::u16string output;
+            code_page_to_utf16(cp, bytes, output, mode);
+            return output;
+        }
+
+        //! Convert text in a single-byte code page to UTF-8, appending to `output`.
+        //! The conversion is stateless, so a stream can be converted one chunk at a time.
+        inline void code_page_to_utf8(code_page cp, std::string_view bytes, std::string& output, conversion_mode mode = conversion_mode::strict)
+        {
+            detail::decode_to_utf8(cp, reinterpret_cast<const unsigned char*>(bytes.data()), bytes.size(), output, mode);
+        }
+
+        inline std::string code_page_to_utf8(code_page cp, std::string_view bytes, conversion_mode mode = conversion_mode::strict)
+        {
+            std::string output;
+            code_page_to_utf8(cp, bytes, output, mode);
+            return output;
+        }
+
+        //! Convert UTF-16 text to a single-byte code page.
+        inline std::string wide_to_code_page(code_page cp, std::wstring_view text, conversion_mode mode = conversion_mode::strict)
+        {
+            std::string output;
+            detail::append_encoded(cp, text, output, mode);
+            return output;
+        }
+
+        //! Convert UTF-16 text to a single-byte code page.
+        inline std::string utf16_to_code_page(code_page cp, std::u16string_view text, conversion_mode mode = conversion_mode::strict)
+        {
+            std::string output;
+            detail::append_encoded(cp, text, output, mode);
+            return output;
+        }
+
+        //! Convert UTF-8 text to a single-byte code page.
+        inline std::string utf8_to_code_page(code_page cp, std::string_view text, conversion_mode mode = conversion_mode::strict)
+        {
+            std::string output;
+            detail::encode_from_utf8(cp, reinterpret_cast<const unsigned char*>(text.data()), text.size(), output, mode, true);
+            return output;
+        }
+
+        //! Converts a stream of UTF-8 text to a single-byte code page one chunk at a time.
+        //! Chunks may split multi-byte sequences; call `finish` after the last chunk.
+        class utf8_to_code_page_converter
+        {
+        public:
+            explicit utf8_to_code_page_converter(code_page cp, conversion_mode mode = conversion_mode::strict) :
+                cp{ cp },
+                mode{ mode }
+            {
+                detail::table(cp);
+            }
+
+            //! Append the conversion of `chunk` to `output`.
+            void convert(std::string_view chunk, std::string& output)
+            {
+                // Complete a sequence split by the previous chunk, one byte at a time.
+                while (!pending.empty() && !chunk.empty())
+                {
+                    pending += chunk.front();
+                    chunk.remove_prefix(1);
+
+                    const auto consumed = detail::encode_from_utf8(cp, reinterpret_cast<const unsigned char*>(pending.data()), pending.size(), output, mode, false);
+                    pending.erase(0, consumed);
+                }
+
+                const auto data = reinterpret_cast<const unsigned char*>(chunk.data());
+                const auto consumed = detail::encode_from_utf8(cp, data, chunk.size(), output, mode, false);
+                pending.append(chunk.substr(consumed));
+            }
+
+            //! Convert the end of a sequence that the last chunk cut short.
+            void finish(std::string& output)
+            {
+                detail::encode_from_utf8(cp, reinterpret_cast<const unsigned char*>(pending.data()), pending.size(), output, mode, true);
+                pending.clear();
+            }
+
+        private:
+            code_page cp;
+            conversion_mode mode;
+            std::string pending; //!< The start of a sequence that the last chunk cut short
+        };
+    }
+}
\ No newline at end of file
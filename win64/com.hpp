@@ -1,16 +1,19 @@
 #pragma once
 
 #include <array>
-#include <functional>
-#include <optional>
-#include <vector>
+#include <new>
+#include <utility>
 
 #include <wrl.h>
 
 #include "Core\log.hpp" // TODO from Essentials of COM 2 solution
 
+#include "class_object_cache.hpp"
 #include "error.hpp"
-#include "registry.hpp"
+#include "function_ref.hpp"
+#include "memory_pool.hpp"
+#include "server_registrar.hpp"
+#include "telemetry.hpp"
 
 namespace windows
 {
@@ -21,11 +24,26 @@ namespace windows
             //! Template for creating an instance of a given COM interface using an instance of some COM class
             //! implementing that interface.
             //! `Class` must inherit `Interface`.
+            //! If `Class` derives from `windows::memory::pooled_allocation<Class>`, the instance is allocated from
+            //! `windows::memory::memory_pool` instead of with `Microsoft::WRL::Make`.
+            //! Pooled classes must be classic COM classes (no weak reference support), since `Make` is bypassed.
             //! If the call succeeds, `result` will be an instance of `Class` with a reference count of 1.
             template <typename Interface, typename Class>
             HRESULT __stdcall instantiate(Interface** result)
             {
-                Microsoft::WRL::ComPtr<Interface> obj = Microsoft::WRL::Make<Class>();
+                Microsoft::WRL::ComPtr<Interface> obj;
+
+                if constexpr (windows::memory::is_pooled<Class>)
+                {
+                    // A new `RuntimeClass` starts with a reference count of 1, which `Attach` takes over.
+                    // The final `Release` calls `delete this`, which returns the memory to the pool.
+                    // Not `new Class`: `RuntimeClass` declares its own `operator new`, which makes that ambiguous.
+                    obj.Attach(windows::memory::pooled_allocation<Class>::create());
+                }
+                else
+                {
+                    obj = Microsoft::WRL::Make<Class>();
+                }
 
                 if (obj == nullptr)
                 {
@@ -39,95 +57,33 @@ namespace windows
                 }
             }
 
-            //! Information for a registry entry that is created upon registration of this COM server
-            struct registry_entry
-            {
-                windows::path path;
-                bool delete_on_unregister;
-                std::optional<std::wstring> name; //!< Default keys in the registry do not have names.
-                std::optional<std::wstring> value; //!< COM doesn't need this, just for humans
-            };
-
-            //! Handles registration and unregistration for the DLL.
-            class server_registrar
-            {
-            public:
-                // TODO template for any 'range' type
-                server_registrar(std::vector<registry_entry> entries, windows::registry::hive hive = windows::registry::hive::local_machine) :
-                    entries{ entries.begin(), entries.end() },
-                    hive{ hive }
-                {
-                }
-
-                // TODO why is this ambiguous?
-                /*server_registrar(std::vector<registry_entry>&& entries) :
-                entries{ std::forward<std::vector<registry_entry>>(entries) }
-                {
-                }*/
-
-                //! Transactionally remove all entries marked for deletion on unregistration.
-                void unregister_entries() const
-                {
-                    windows::ktm::transact([this](const windows::ktm::transaction& t) { _unregister_entries(t); });
-                }
-
-                //! Transactionally create all entries specified in `entries`.
-                void register_entries() const
-                {
-                    windows::ktm::transact([this](const windows::ktm::transaction& t) { _register_entries(t); });
-                }
-
-            private:
-                void _unregister_entries(const windows::ktm::transaction& transaction) const
-                {
-                    for (const auto& entry : entries)
-                    {
-                        if (entry.delete_on_unregister) windows::registry::delete_subtree(hive, entry.path, transaction);
-                        else continue;
-                    }
-                }
-
-                void _register_entries(const ktm::transaction& transaction) const
-                {
-                    _unregister_entries(transaction);
-
-                    for (const auto& entry : entries)
-                    {
-                        const auto key = windows::registry::create_key(hive, entry.path, KEY_WRITE, transaction);
-
-                        if (entry.value)
-                        {
-                            windows::registry::set_value_string(key.get(), entry.name, *entry.value);
-                        }
-                    }
-                }
-
-            private:
-                std::vector<registry_entry> entries;
-                windows::registry::hive hive;
-            };
-
             //! Execute a function and convert exceptions to `HRESULT`s.
-            inline HRESULT entry_point(const std::function<void(void)>& function)
+            //! Each failure is counted in `windows::telemetry`.
+            //! `function` may be any callable, including a `windows::function_ref`.
+            template <typename Function>
+            HRESULT entry_point(Function&& function)
             {
                 try
                 {
-                    function();
+                    std::forward<Function>(function)();
                     return S_OK;
                 }
                 catch (const win32_wexception& e)
                 {
                     LOG_ERROR(e.message());
+                    telemetry::record_failure(telemetry::failure_source::entry_point, e.hresult());
                     return e.hresult();
                 }
                 catch (const std::exception& e)
                 {
                     LOG_ERROR(windows::locale::multibyte_to_wide(e.what()));
+                    telemetry::record_failure(telemetry::failure_source::entry_point, E_FAIL);
                     return E_FAIL;
                 }
                 catch (...)
                 {
                     LOG_ERROR(L"Unexpected error");
+                    telemetry::record_failure(telemetry::failure_source::entry_point, E_UNEXPECTED);
                     return E_UNEXPECTED;
                 }
             }
@@ -145,13 +101,58 @@ namespace windows
             }
 
             //! Wraps a call to `CoGetClassObject`
-            template <typename Class, typename IClassObject>
-            Microsoft::WRL::ComPtr<IClassObject> __stdcall get_class_object(DWORD class_context = CLSCTX_INPROC_SERVER)
+            template <typename IClassObject>
+            Microsoft::WRL::ComPtr<IClassObject> __stdcall get_class_object(REFCLSID clsid, DWORD class_context = CLSCTX_INPROC_SERVER)
             {
                 Microsoft::WRL::ComPtr<IClassObject> class_object;
-                throw_if_failed(::CoGetClassObject(__uuidof(Class), class_context, nullptr, __uuidof(IClassObject), &class_object));
+                throw_if_failed(::CoGetClassObject(clsid, class_context, nullptr, __uuidof(IClassObject), &class_object));
                 return class_object;
             }
+
+            //! Wraps a call to `CoGetClassObject`
+            template <typename Class, typename IClassObject>
+            Microsoft::WRL::ComPtr<IClassObject> __stdcall get_class_object(DWORD class_context = CLSCTX_INPROC_SERVER)
+            {
+                return get_class_object<IClassObject>(__uuidof(Class), class_context);
+            }
+
+            namespace detail
+            {
+                //! Traits class for `class_object_cache` that activates class objects with `CoGetClassObject`
+                struct class_factory_traits
+                {
+                    using key_type = CLSID;
+                    using pointer = Microsoft::WRL::ComPtr<IClassFactory>;
+
+                    static pointer get_class_object(const key_type& clsid, unsigned long class_context)
+                    {
+                        return client::get_class_object<IClassFactory>(clsid, class_context);
+                    }
+                };
+            }
+
+            //! Per-thread cache of the `IClassFactory` objects used by `create_instance(cached_class_object)`.
+            //! Call `class_factory_cache::flush()` on each thread before it calls `CoUninitialize`.
+            using class_factory_cache = windows::com::class_object_cache<detail::class_factory_traits>;
+
+            //! Tag type for selecting the `create_instance` overload that uses `class_factory_cache`.
+            struct cached_class_object_t
+            {
+            };
+
+            constexpr cached_class_object_t cached_class_object{};
+
+            //! Create an instance of `Class` from the calling thread's cached class factory
+            //! instead of calling `CoCreateInstance`.
+            template <typename Interface, typename Class>
+            Microsoft::WRL::ComPtr<Interface> __stdcall create_instance(cached_class_object_t, DWORD class_context = CLSCTX_INPROC_SERVER)
+            {
+                const auto factory = class_factory_cache::get(__uuidof(Class), class_context);
+
+                Microsoft::WRL::ComPtr<Interface> instance;
+                throw_if_failed(factory->CreateInstance(nullptr, __uuidof(Interface), &instance));
+                return instance;
+            }
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,315 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#include "handle.hpp"
+#include "memory_pool.hpp"
+
+namespace windows
+{
+    //! Counters for a `deferred_closer`.
+    struct deferred_close_statistics
+    {
+        unsigned long long enqueued; //!< Handles queued for closing
+        unsigned long long closed; //!< Queued handles that have been closed
+        unsigned long long batches; //!< Times the background thread emptied the queue
+        unsigned long long largest_batch; //!< Most handles closed in one batch
+        unsigned long long flushes; //!< Calls to `flush`
+
+        //! Handles queued but not yet closed.
+        unsigned long long pending() const
+        {
+            return enqueued - closed;
+        }
+    };
+
+    //! Closes handles on a background thread, so that slow closes do not land on the threads that release them.
+    //! Producers push onto a lock-free stack; the background thread takes the whole stack at once and closes
+    //! the handles in the order they were queued. There is one closer, and one thread, for each `Traits`,
+    //! started on first use and stopped after closing the remaining handles when the process exits.
+    template <typename Traits>
+    class deferred_closer
+    {
+    public:
+        using pointer = typename Traits::pointer;
+
+        //! How long the background thread lets handles build up after closing a batch, unless a `flush` is waiting.
+        static constexpr std::chrono::milliseconds batch_interval{ 1 };
+
+        deferred_closer() = delete;
+
+        //! Queue `value` to be closed with `Traits::close`.
+        //! Closes it immediately if there is no memory to queue it or the closer has already stopped.
+        static void enqueue(pointer value) noexcept
+        {
+            // Announce the push before checking `stopped`, so that the closer either waits for it before its final
+            // drain or is seen to have stopped here.
+            producers.fetch_add(1, std::memory_order_seq_cst);
+            auto n = stopped.load(std::memory_order_seq_cst) ? nullptr : memory::memory_pool::allocate(sizeof(node));
+            if (n == nullptr)
+            {
+                producers.fetch_sub(1, std::memory_order_release);
+                Traits::close(value);
+                return;
+            }
+
+            instance().push(new (n) node{ value, nullptr, nullptr });
+            producers.fetch_sub(1, std::memory_order_release);
+        }
+
+        //! Block until every handle queued before the call has been closed.
+        static void flush()
+        {
+            if (stopped.load(std::memory_order_acquire))
+            {
+                return;
+            }
+
+            auto& self = instance();
+            self.flushes.fetch_add(1, std::memory_order_relaxed);
+
+            std::unique_lock<std::mutex> lock{ self.mutex };
+            ++self.flushes_waiting;
+            lock.unlock();
+
+            bool done = false;
+            node barrier{ Traits::invalid(), nullptr, &done };
+            self.push(&barrier);
+            self.wake.notify_one();
+
+            lock.lock();
+            self.flushed.wait(lock, [&] { return done; });
+            --self.flushes_waiting;
+        }
+
+        static deferred_close_statistics statistics()
+        {
+            auto& self = instance();
+            deferred_close_statistics result;
+            result.closed = self.closed.load(std::memory_order_acquire);
+            result.enqueued = self.enqueued.load(std::memory_order_relaxed);
+            result.batches = self.batches.load(std::memory_order_relaxed);
+            result.largest_batch = self.largest_batch.load(std::memory_order_relaxed);
+            result.flushes = self.flushes.load(std::memory_order_relaxed);
+            return result;
+        }
+
+        //! Handles queued but not yet closed.
+        static unsigned long long depth()
+        {
+            return statistics().pending();
+        }
+
+    private:
+        struct node
+        {
+            pointer value;
+            node* next;
+            bool* barrier; //!< Set by `flush` instead of a handle; the flag to raise once the node is reached
+        };
+
+        //! The closer's state. A separate class, so that `deferred_closer` itself has no instances.
+        class state
+        {
+        public:
+            state() :
+                worker{ start(*this) }
+            {
+            }
+
+            ~state()
+            {
+                // From here on `enqueue` closes handles itself. Wait out the pushes that started before, so that the
+                // background thread's final drain sees them.
+                stopped.store(true, std::memory_order_seq_cst);
+                while (producers.load(std::memory_order_seq_cst) != 0)
+                {
+                    std::this_thread::yield();
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock{ mutex };
+                    stopping = true;
+                }
+
+                wake.notify_one();
+                worker.join();
+            }
+
+            void push(node* n) noexcept
+            {
+                if (n->barrier == nullptr)
+                {
+                    enqueued.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                auto old = head.load(std::memory_order_relaxed);
+                do
+                {
+                    n->next = old;
+                } while (!head.compare_exchange_weak(old, n, std::memory_order_seq_cst, std::memory_order_relaxed));
+
+                // The background thread raises `sleeping` before it checks the stack for the last time, and the push
+                // comes before this check, so either it sees the handle or this sees it sleeping. Taking the lock
+                // waits until it is actually waiting on `wake`, so the notification is not lost.
+                if (sleeping.load(std::memory_order_seq_cst))
+                {
+                    {
+                        std::lock_guard<std::mutex> lock{ mutex };
+                    }
+
+                    wake.notify_one();
+                }
+            }
+
+        private:
+            //! Build the pool's statics before starting the background thread, so that they finish construction
+            //! first and are destroyed after this state, even if the closer is first used by `flush` or `statistics`.
+            static std::thread start(state& s)
+            {
+                memory::memory_pool::statistics();
+                return std::thread{ [&s] { s.run(); } };
+            }
+
+            void run()
+            {
+                std::unique_lock<std::mutex> lock{ mutex };
+                for (;;)
+                {
+                    if (const auto batch = head.exchange(nullptr, std::memory_order_acquire))
+                    {
+                        lock.unlock();
+                        close_batch(batch);
+                        lock.lock();
+
+                        // Let the next batch build up, unless someone is waiting for it.
+                        wake.wait_for(lock, batch_interval, [this] { return stopping || flushes_waiting > 0; });
+                        continue;
+                    }
+                    else if (stopping)
+                    {
+                        return;
+                    }
+
+                    sleeping.store(true, std::memory_order_seq_cst);
+                    wake.wait(lock, [this] { return stopping || head.load(std::memory_order_seq_cst) != nullptr; });
+                    sleeping.store(false, std::memory_order_relaxed);
+                }
+            }
+
+            void close_batch(node* batch)
+            {
+                // The stack holds the newest handle first.
+                node* queue = nullptr;
+                while (batch != nullptr)
+                {
+                    const auto next = batch->next;
+                    batch->next = queue;
+                    queue = batch;
+                    batch = next;
+                }
+
+                unsigned long long size = 0;
+                node* barriers = nullptr;
+                while (queue != nullptr)
+                {
+                    const auto n = queue;
+                    queue = n->next;
+
+                    if (n->barrier != nullptr)
+                    {
+                        n->next = barriers;
+                        barriers = n;
+                    }
+                    else
+                    {
+                        Traits::close(n->value);
+                        n->~node();
+                        memory::memory_pool::deallocate(n, sizeof(node));
+                        ++size;
+                    }
+                }
+
+                // Publish the statistics before raising the barriers, so that `flush` returns with them up to date.
+                batches.fetch_add(1, std::memory_order_relaxed);
+                if (size > largest_batch.load(std::memory_order_relaxed))
+                {
+                    largest_batch.store(size, std::memory_order_relaxed);
+                }
+                closed.fetch_add(size, std::memory_order_release);
+
+                if (barriers != nullptr)
+                {
+                    // Each barrier belongs to a thread in `flush`, which may return as soon as its flag is set.
+                    {
+                        std::lock_guard<std::mutex> lock{ mutex };
+                        while (barriers != nullptr)
+                        {
+                            const auto done = barriers->barrier;
+                            barriers = barriers->next;
+                            *done = true;
+                        }
+                    }
+                    flushed.notify_all();
+                }
+            }
+
+        public:
+            std::atomic<node*> head{ nullptr };
+            std::atomic<unsigned long long> enqueued{ 0 };
+            std::atomic<unsigned long long> closed{ 0 };
+            std::atomic<unsigned long long> batches{ 0 };
+            std::atomic<unsigned long long> largest_batch{ 0 };
+            std::atomic<unsigned long long> flushes{ 0 };
+            std::atomic<bool> sleeping{ false }; //!< Whether the background thread is waiting, or about to wait, on `wake`
+
+            std::mutex mutex;
+            std::condition_variable wake; //!< Signaled when the stack stops being empty, a `flush` starts or the closer stops
+            std::condition_variable flushed; //!< Signaled when the background thread reaches a barrier
+            int flushes_waiting = 0; //!< Threads in `flush`
+
+        private:
+            bool stopping = false;
+            std::thread worker; //!< Declared last, so that it starts after everything it uses is initialized
+        };
+
+        static state& instance()
+        {
+            static state s;
+            return s;
+        }
+
+        //! Set once the closer starts stopping during static destruction. A plain static, so that it outlives `instance`.
+        static inline std::atomic<bool> stopped{ false };
+
+        //! Threads inside `enqueue` that may still push onto the stack.
+        static inline std::atomic<unsigned> producers{ 0 };
+    };
+
+    //! Traits for a `unique_handle` that closes its handle with a `deferred_closer` instead of on the calling thread.
+    //! Call `deferred_closer<Traits>::flush` where the close must have finished before continuing.
+    template <typename Traits>
+    struct deferred_close_traits
+    {
+        using pointer = typename Traits::pointer;
+
+        static auto invalid() throw() -> pointer
+        {
+            return Traits::invalid();
+        }
+
+        static auto close(pointer value) throw() -> void
+        {
+            deferred_closer<Traits>::enqueue(value);
+        }
+    };
+
+    using deferred_null_handle = unique_handle<deferred_close_traits<null_handle_traits>>;
+    using deferred_invalid_handle = unique_handle<deferred_close_traits<invalid_handle_traits>>;
+}
\ No newline at end of file
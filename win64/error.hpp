@@ -1,28 +1,68 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
+#include <cwchar>
 #include <string>
+#include <string_view>
+#include <utility>
 
 #include <Windows.h>
 #include <winerror.h>
 
+#include "telemetry.hpp"
+
 namespace windows
 {
+    namespace detail
+    {
+        //! The name of a common `HRESULT` (for example, `S_OK`), or null if it is not one of them.
+        inline const wchar_t* hresult_name(HRESULT hr) noexcept
+        {
+            switch (hr)
+            {
+            case S_OK: return L"S_OK";
+            case E_ACCESSDENIED: return L"E_ACCESSDENIED";
+            case E_POINTER: return L"E_POINTER";
+            case E_NOINTERFACE: return L"E_NOINTERFACE";
+            case E_UNEXPECTED: return L"E_UNEXPECTED";
+            case E_FAIL: return L"E_FAIL";
+            case REGDB_E_CLASSNOTREG: return L"REGDB_E_CLASSNOTREG";
+            default: return nullptr;
+            }
+        }
+
+        constexpr std::size_t max_message_size = 2 << 10;
+
+        //! Wraps a call to `FormatMessage` with the `FORMAT_MESSAGE_FROM_SYSTEM` flag set.
+        //! Returns the length of the message, or 0 if there is none.
+        inline DWORD format_system_message(DWORD error, std::array<wchar_t, max_message_size>& buffer) noexcept
+        {
+            return ::FormatMessage(
+                FORMAT_MESSAGE_FROM_SYSTEM,
+                nullptr,
+                error,
+                MAKELANGID(LANG_ENGLISH, SUBLANG_ENGLISH_US),
+                buffer.data(),
+                static_cast<DWORD>(buffer.size()),
+                nullptr);
+        }
+
+        constexpr const wchar_t* no_error_message = L"No error message is available";
+    }
+
     //! Get the name of a common `HRESULT` (for example, `S_OK`) as a string
     //! or convert the numerical value to a string if the name is unknown.
     //! This method should only be used for diagnostics and not for error-checking.
     inline std::wstring hresult_to_wstring(HRESULT hr)
     {
-        switch (hr)
+        if (const auto name = detail::hresult_name(hr))
+        {
+            return name;
+        }
+        else
         {
-        case S_OK: return L"S_OK";
-        case E_ACCESSDENIED: return L"E_ACCESSDENIED";
-        case E_POINTER: return L"E_POINTER";
-        case E_NOINTERFACE: return L"E_NOINTERFACE";
-        case E_UNEXPECTED: return L"E_UNEXPECTED";
-        case E_FAIL: return L"E_FAIL";
-        case REGDB_E_CLASSNOTREG: return L"REGDB_E_CLASSNOTREG";
-        default: return std::to_wstring(hr);
+            return std::to_wstring(hr);
         }
     }
 
@@ -30,21 +70,12 @@ namespace windows
     //! Wraps a call to `FormatMessage` with the `FORMAT_MESSAGE_FROM_SYSTEM` flag set.
     inline std::wstring system_error_message(DWORD error)
     {
-        constexpr size_t max_size = 2 << 10;
-        std::array<wchar_t, max_size> buffer;
-
-        const auto size = ::FormatMessage(
-            FORMAT_MESSAGE_FROM_SYSTEM,
-            nullptr,
-            error,
-            MAKELANGID(LANG_ENGLISH, SUBLANG_ENGLISH_US),
-            buffer.data(),
-            static_cast<DWORD>(buffer.size()),
-            nullptr);
+        std::array<wchar_t, detail::max_message_size> buffer;
+        const auto size = detail::format_system_message(error, buffer);
 
         if (size == 0)
         {
-            return L"No error message is available";
+            return detail::no_error_message;
         }
         else
         {
@@ -76,6 +107,11 @@ namespace windows
         {
         }
 
+        wexception(std::wstring&& message) :
+            _message{ std::move(message) }
+        {
+        }
+
         virtual ~wexception()
         {
         }
@@ -92,7 +128,7 @@ namespace windows
 
     //! Exception class that generalizes the various error codes used in Windows APIs
     //! and maps them to `HRESULT`.
-    //! The constructors perform a dynamic string allocation and so can cause a second exception
+    //! The constructors perform one dynamic string allocation and so can cause a second exception
     //! to be thrown while this one is being constructed if the system is out of memory.
     //! That condition is assumed to be sufficiently rare that it may be ignored.
     class win32_wexception : public wexception
@@ -100,16 +136,18 @@ namespace windows
     public:
         // `HRESULT` and `LSTATUS`
         win32_wexception(long error_code) :
-            wexception{ error_message(hr) },
+            wexception{ error_message(error_code) },
             hr{ HRESULT_FROM_WIN32(error_code) } // if `error_code` is already an `HRESULT`, this will leave it unchanged
         {
+            telemetry::record_failure(telemetry::failure_source::exception, hr);
         }
 
         // Separate `DWORD` constructor to avoid C++11's "narrowing conversion" error
         win32_wexception(DWORD error_code) :
-            wexception{ error_message(hr) },
+            wexception{ error_message(error_code) },
             hr{ HRESULT_FROM_WIN32(error_code) }
         {
+            telemetry::record_failure(telemetry::failure_source::exception, hr);
         }
 
     public:
@@ -122,29 +160,54 @@ namespace windows
     private:
         HRESULT hr;
 
+        //! The name or number of the `HRESULT`, then the system's message for it.
+        //! The parts are formatted on the stack, so that the message is the only allocation.
         template <typename Error>
         static std::wstring error_message(Error error)
         {
             const auto hr = HRESULT_FROM_WIN32(error);
-            return hresult_to_wstring(hr) + L": " + system_error_message(hr);
+
+            std::array<wchar_t, 24> number;
+            auto name = detail::hresult_name(hr);
+            if (name == nullptr)
+            {
+                std::swprintf(number.data(), number.size(), L"%ld", static_cast<long>(hr));
+                name = number.data();
+            }
+
+            std::array<wchar_t, detail::max_message_size> buffer;
+            const auto size = detail::format_system_message(static_cast<DWORD>(HRESULT_CODE(hr)), buffer);
+            const auto text = size == 0 ? std::wstring_view{ detail::no_error_message } : std::wstring_view{ buffer.data(), size };
+
+            std::wstring message;
+            message.reserve(std::wcslen(name) + 2 + text.size());
+            message += name;
+            message += L": ";
+            message += text;
+            return message;
         }
     };
 
     //! Test an `HRESULT`, `LSTATUS`, or Win32 error code for failure and throw a `win32_wexception` if it failed.
+    //! Failures are counted in `windows::telemetry`; the success path does no extra work.
     inline void throw_if_failed(long error_code)
     {
         if (HRESULT_FROM_WIN32(error_code) != S_OK)
         {
+            telemetry::record_failure(telemetry::failure_source::throw_if_failed, HRESULT_FROM_WIN32(error_code));
             throw win32_wexception{ error_code };
         }
     }
 
     //! Test a `BOOL` for failure and throw `GetLastError` as a `win32_wexception` if it failed.
+    //! Failures are counted in `windows::telemetry`; the success path does no extra work.
     inline void throw_if_failed(BOOL success)
     {
         if (!success)
         {
-            throw win32_wexception{ ::GetLastError() };
+            const auto error = ::GetLastError();
+            telemetry::record_failure(telemetry::failure_source::throw_if_failed, HRESULT_FROM_WIN32(error));
+            throw win32_wexception{ error };
         }
     }
 }
\ No newline at end of file
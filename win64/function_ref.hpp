@@ -0,0 +1,85 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace windows
+{
+    template <typename Signature>
+    class function_ref;
+
+    //! A non-owning reference to a callable object, for parameters that are only called before the function returns.
+    //! Unlike `std::function`, it never allocates and is two pointers in size, but the callable must outlive it.
+    //! A function taking a template parameter instead is instantiated once per callable type, but can inline a lambda;
+    //! pass a `function_ref` to such a function to instantiate it only once for many callables.
+    //! Functions and function pointers are stored by value, so they need not outlive it.
+    template <typename Result, typename... Args>
+    class function_ref<Result(Args...)>
+    {
+    public:
+        template <typename Function, typename = std::enable_if_t<
+            !std::is_same_v<std::decay_t<Function>, function_ref> &&
+            std::is_object_v<std::remove_reference_t<Function>> &&
+            !std::is_function_v<std::remove_pointer_t<std::decay_t<Function>>> &&
+            std::is_invocable_r_v<Result, Function&, Args...>>>
+        function_ref(Function&& function) noexcept :
+            thunk{ &call_object<std::remove_reference_t<Function>> }
+        {
+            callable.object = const_cast<void*>(static_cast<const void*>(std::addressof(function)));
+        }
+
+        template <typename Function, typename = std::enable_if_t<
+            std::is_function_v<Function> &&
+            std::is_invocable_r_v<Result, Function*, Args...>>>
+        function_ref(Function* function) noexcept :
+            thunk{ &call_function<Function> }
+        {
+            callable.function = reinterpret_cast<void(*)()>(function);
+        }
+
+        function_ref(const function_ref&) noexcept = default;
+        function_ref& operator=(const function_ref&) noexcept = default;
+
+        Result operator()(Args... args) const
+        {
+            return thunk(callable, std::forward<Args>(args)...);
+        }
+
+    private:
+        union storage
+        {
+            void* object;
+            void(*function)();
+        };
+
+        template <typename Function>
+        static Result call_object(storage callable, Args... args)
+        {
+            return call(*static_cast<Function*>(callable.object), std::forward<Args>(args)...);
+        }
+
+        template <typename Function>
+        static Result call_function(storage callable, Args... args)
+        {
+            return call(reinterpret_cast<Function*>(callable.function), std::forward<Args>(args)...);
+        }
+
+        template <typename Function>
+        static Result call(Function&& function, Args... args)
+        {
+            if constexpr (std::is_void_v<Result>)
+            {
+                std::invoke(std::forward<Function>(function), std::forward<Args>(args)...);
+            }
+            else
+            {
+                return std::invoke(std::forward<Function>(function), std::forward<Args>(args)...);
+            }
+        }
+
+        storage callable;
+        Result(*thunk)(storage, Args...);
+    };
+}
\ No newline at end of file
@@ -1,12 +1,16 @@
 #pragma once
 
-#include <functional>
+#include <utility>
 #include <Windows.h> // required for ktmw32.h
 #include <ktmw32.h>
+#if defined(_MSC_VER)
 #pragma comment(lib, "ktmw32.lib")
+#endif
 
 #include "handle.hpp"
 #include "error.hpp"
+#include "function_ref.hpp"
+#include "trace.hpp"
 
 namespace windows
 {
@@ -48,7 +52,7 @@ namespace windows
                 throw_if_failed(::CommitTransaction(get()));
             }
 
-            const HANDLE get() const
+            HANDLE get() const
             {
                 return handle.get();
             }
@@ -65,10 +69,14 @@ namespace windows
         //! Execute a `transaction` -> `void` function as a transaction.
         //! If the function throws an exception, roll it back.
         //! Otherwise, commit it.
-        inline void transact(const std::function<void(const transaction&)>& action)
+        //! `action` may be any callable, including a `windows::function_ref`.
+        template <typename Action>
+        void transact(Action&& action)
         {
+            WIN64_TRACE_SPAN(windows::trace::event_id::ktm_transact, 0);
+
             const windows::ktm::transaction t{};
-            action(t);
+            std::forward<Action>(action)(t);
             t.commit();
         }
     }
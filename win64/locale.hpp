@@ -1,21 +1,137 @@
 #pragma once
 
-#include <codecvt>
+#include <cstddef>
+#include <memory_resource>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <Windows.h>
 
+#include "unicode.hpp"
+
 namespace windows
 {
     namespace locale
     {
+        namespace detail
+        {
+            //! Convert UTF-8 to UTF-16 into `wide`, which must be empty.
+            //! `wide` is allocated once, and nothing else is.
+            template <typename WideString>
+            void utf8_to_utf16(std::string_view multibyte, WideString& wide)
+            {
+                // UTF-16 never takes more code units than UTF-8 takes bytes.
+                wide.resize(multibyte.size());
+                auto out = &wide[0];
+
+                auto p = reinterpret_cast<const unsigned char*>(multibyte.data());
+                const auto end = p + multibyte.size();
+                while (p != end)
+                {
+                    if (*p < 0x80)
+                    {
+                        *out++ = *p++;
+                        continue;
+                    }
+
+                    char32_t c;
+                    const auto length = decode_utf8(p, end, c);
+                    if (length <= 0)
+                    {
+                        throw std::range_error{ "invalid UTF-8" };
+                    }
+
+                    out = encode_utf16(c, out);
+                    p += length;
+                }
+
+                wide.resize(out - wide.data());
+            }
+
+            //! Convert UTF-16 to UTF-8 into `multibyte`, which must be empty.
+            //! `multibyte` is allocated once, and nothing else is.
+            template <typename MultibyteString>
+            void utf16_to_utf8(std::wstring_view wide, MultibyteString& multibyte)
+            {
+                const auto begin = wide.data();
+                const auto end = begin + wide.size();
+
+                std::size_t size = 0;
+                for (auto p = begin; p != end; )
+                {
+                    if (static_cast<std::make_unsigned_t<wchar_t>>(*p) < 0x80)
+                    {
+                        ++size;
+                        ++p;
+                        continue;
+                    }
+
+                    char32_t c;
+                    const auto length = decode_utf16(p, end, c);
+                    if (length == 0)
+                    {
+                        throw std::range_error{ "invalid UTF-16" };
+                    }
+
+                    size += utf8_length(c);
+                    p += length;
+                }
+
+                multibyte.resize(size);
+                auto out = &multibyte[0];
+                for (auto p = begin; p != end; )
+                {
+                    if (static_cast<std::make_unsigned_t<wchar_t>>(*p) < 0x80)
+                    {
+                        *out++ = static_cast<char>(*p++);
+                        continue;
+                    }
+
+                    char32_t c;
+                    p += decode_utf16(p, end, c);
+                    out = encode_utf8(c, out);
+                }
+            }
+        }
+
+        //! Convert UTF-8 to UTF-16.
+        //! Throws `std::range_error` if `multibyte` is not valid UTF-8.
         inline std::wstring multibyte_to_wide(const std::string& multibyte)
         {
-            return std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>>{}.from_bytes(multibyte);
+            std::wstring wide;
+            detail::utf8_to_utf16(multibyte, wide);
+            return wide;
         }
 
+        //! Convert UTF-16 to UTF-8.
+        //! Throws `std::range_error` if `wide` has an unpaired surrogate.
         inline std::string wide_to_multibyte(const std::wstring& wide)
         {
-            return std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>>{}.to_bytes(wide);
+            std::string multibyte;
+            detail::utf16_to_utf8(wide, multibyte);
+            return multibyte;
+        }
+
+        namespace pmr
+        {
+            //! Convert UTF-8 to UTF-16, allocating the result from `resource`.
+            //! Throws `std::range_error` if `multibyte` is not valid UTF-8.
+            inline std::pmr::wstring multibyte_to_wide(std::string_view multibyte, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            {
+                std::pmr::wstring wide{ resource };
+                detail::utf8_to_utf16(multibyte, wide);
+                return wide;
+            }
+
+            //! Convert UTF-16 to UTF-8, allocating the result from `resource`.
+            //! Throws `std::range_error` if `wide` has an unpaired surrogate.
+            inline std::pmr::string wide_to_multibyte(std::wstring_view wide, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            {
+                std::pmr::string multibyte{ resource };
+                detail::utf16_to_utf8(wide, multibyte);
+                return multibyte;
+            }
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,394 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace windows
+{
+    namespace memory
+    {
+        //! Counters for `memory_pool`, summed over all threads.
+        struct pool_statistics
+        {
+            unsigned long long allocations; //!< Blocks handed out by the pool
+            unsigned long long deallocations; //!< Blocks returned to the pool
+            unsigned long long oversize_allocations; //!< Requests larger than `memory_pool::max_block_size`, forwarded to `operator new`
+            unsigned long long chunks; //!< Chunks requested from `operator new` to refill the pool
+            unsigned long long reserved_bytes; //!< Total size of those chunks
+        };
+
+        //! A size-segregated pool of small memory blocks.
+        //! Each thread allocates from and frees to its own free lists without locking;
+        //! blocks move between threads in batches through a shared free list when a thread runs out or holds too many.
+        //! Memory is never returned to the system, so blocks stay valid for the destructors of other statics.
+        //! A thread may keep allocating and freeing blocks after its own cache is destroyed, from its other
+        //! `thread_local` destructors; those blocks go straight to and from the shared free lists.
+        class memory_pool
+        {
+        public:
+            static constexpr std::size_t granularity = alignof(std::max_align_t);
+            static constexpr std::size_t max_block_size = 512;
+
+            memory_pool() = delete;
+
+            //! Allocate a block of at least `size` bytes, aligned to `granularity`.
+            //! Returns `nullptr` if the system is out of memory.
+            static void* allocate(std::size_t size) noexcept
+            {
+                if (cache_destroyed)
+                {
+                    return size > max_block_size ? ::operator new(size, std::nothrow) : shared().allocate(size_class_of(size));
+                }
+
+                auto& cache = local_cache();
+
+                if (size > max_block_size)
+                {
+                    increment(cache.oversize_allocations);
+                    return ::operator new(size, std::nothrow);
+                }
+
+                const auto size_class = size_class_of(size);
+                auto& list = cache.lists[size_class];
+
+                if (list.head == nullptr && !shared().refill(size_class, list))
+                {
+                    return nullptr;
+                }
+
+                increment(cache.allocations);
+                return list.pop();
+            }
+
+            //! Return a block obtained from `allocate`.
+            //! `size` must be the size that was passed to `allocate`.
+            static void deallocate(void* block, std::size_t size) noexcept
+            {
+                if (block == nullptr)
+                {
+                    return;
+                }
+                else if (size > max_block_size)
+                {
+                    ::operator delete(block);
+                    return;
+                }
+                else if (cache_destroyed)
+                {
+                    shared().deallocate(size_class_of(size), block);
+                    return;
+                }
+
+                auto& cache = local_cache();
+                const auto size_class = size_class_of(size);
+                auto& list = cache.lists[size_class];
+
+                list.push(static_cast<free_block*>(block));
+                increment(cache.deallocations);
+
+                if (list.count > 2 * batch_size)
+                {
+                    shared().release(size_class, list, batch_size);
+                }
+            }
+
+            //! Get the counters for all threads, including threads that have exited.
+            static pool_statistics statistics()
+            {
+                return shared().statistics();
+            }
+
+        private:
+            static constexpr std::size_t size_class_count = max_block_size / granularity;
+            static constexpr std::size_t batch_size = 32;
+            static constexpr std::size_t chunk_size = 64 * 1024;
+
+            struct free_block
+            {
+                free_block* next;
+            };
+
+            struct free_list
+            {
+                free_block* head = nullptr;
+                std::size_t count = 0;
+
+                void push(free_block* block)
+                {
+                    block->next = head;
+                    head = block;
+                    ++count;
+                }
+
+                free_block* pop()
+                {
+                    const auto block = head;
+                    head = block->next;
+                    --count;
+                    return block;
+                }
+
+                //! Move up to `n` blocks from this list to `other`.
+                void transfer(free_list& other, std::size_t n)
+                {
+                    for (; n > 0 && head != nullptr; --n)
+                    {
+                        other.push(pop());
+                    }
+                }
+            };
+
+            //! Each thread owns its counters, so it updates them with plain loads and stores.
+            //! They are atomic only so that `statistics` can read them from another thread.
+            using counter = std::atomic<unsigned long long>;
+
+            static void increment(counter& c) noexcept
+            {
+                c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+
+            struct thread_cache
+            {
+                std::array<free_list, size_class_count> lists;
+                counter allocations{ 0 };
+                counter deallocations{ 0 };
+                counter oversize_allocations{ 0 };
+                thread_cache* previous = nullptr;
+                thread_cache* next = nullptr;
+
+                thread_cache()
+                {
+                    shared().attach(this);
+                }
+
+                ~thread_cache()
+                {
+                    shared().detach(this);
+                    cache_destroyed = true;
+                }
+            };
+
+            //! Never destroyed; see `shared`.
+            class shared_heap
+            {
+            public:
+                //! Move a batch of blocks into `list`, carving a new chunk if the shared list is empty.
+                bool refill(std::size_t size_class, free_list& list) noexcept
+                {
+                    const std::lock_guard<std::mutex> lock{ mutex };
+                    auto& shared_list = lists[size_class];
+
+                    if (shared_list.head == nullptr && !carve_chunk(size_class, shared_list))
+                    {
+                        return false;
+                    }
+
+                    shared_list.transfer(list, batch_size);
+                    return true;
+                }
+
+                void release(std::size_t size_class, free_list& list, std::size_t n) noexcept
+                {
+                    const std::lock_guard<std::mutex> lock{ mutex };
+                    list.transfer(lists[size_class], n);
+                }
+
+                //! Allocate one block for a thread whose cache has been destroyed.
+                void* allocate(std::size_t size_class) noexcept
+                {
+                    const std::lock_guard<std::mutex> lock{ mutex };
+                    auto& shared_list = lists[size_class];
+
+                    if (shared_list.head == nullptr && !carve_chunk(size_class, shared_list))
+                    {
+                        return nullptr;
+                    }
+
+                    ++retired.allocations;
+                    return shared_list.pop();
+                }
+
+                //! Free one block for a thread whose cache has been destroyed.
+                void deallocate(std::size_t size_class, void* block) noexcept
+                {
+                    const std::lock_guard<std::mutex> lock{ mutex };
+                    lists[size_class].push(static_cast<free_block*>(block));
+                    ++retired.deallocations;
+                }
+
+                void attach(thread_cache* cache) noexcept
+                {
+                    const std::lock_guard<std::mutex> lock{ mutex };
+
+                    cache->next = caches;
+                    if (caches != nullptr)
+                    {
+                        caches->previous = cache;
+                    }
+                    caches = cache;
+                }
+
+                void detach(thread_cache* cache) noexcept
+                {
+                    const std::lock_guard<std::mutex> lock{ mutex };
+
+                    for (std::size_t i = 0; i < size_class_count; ++i)
+                    {
+                        cache->lists[i].transfer(lists[i], cache->lists[i].count);
+                    }
+
+                    retired.allocations += cache->allocations.load(std::memory_order_relaxed);
+                    retired.deallocations += cache->deallocations.load(std::memory_order_relaxed);
+                    retired.oversize_allocations += cache->oversize_allocations.load(std::memory_order_relaxed);
+
+                    (cache->previous != nullptr ? cache->previous->next : caches) = cache->next;
+                    if (cache->next != nullptr)
+                    {
+                        cache->next->previous = cache->previous;
+                    }
+                }
+
+                pool_statistics statistics()
+                {
+                    const std::lock_guard<std::mutex> lock{ mutex };
+                    auto result = retired;
+
+                    for (auto cache = caches; cache != nullptr; cache = cache->next)
+                    {
+                        result.allocations += cache->allocations.load(std::memory_order_relaxed);
+                        result.deallocations += cache->deallocations.load(std::memory_order_relaxed);
+                        result.oversize_allocations += cache->oversize_allocations.load(std::memory_order_relaxed);
+                    }
+
+                    result.chunks = chunk_count;
+                    result.reserved_bytes = chunk_count * chunk_size;
+                    return result;
+                }
+
+            private:
+                bool carve_chunk(std::size_t size_class, free_list& list) noexcept
+                {
+                    const auto chunk = static_cast<unsigned char*>(::operator new(chunk_size, std::nothrow));
+                    if (chunk == nullptr)
+                    {
+                        return false;
+                    }
+
+                    // The first `granularity` bytes of each chunk link it into `chunks`.
+                    const auto header = reinterpret_cast<free_block*>(chunk);
+                    header->next = chunks;
+                    chunks = header;
+                    ++chunk_count;
+
+                    const auto block_size = (size_class + 1) * granularity;
+                    for (std::size_t offset = granularity; offset + block_size <= chunk_size; offset += block_size)
+                    {
+                        list.push(reinterpret_cast<free_block*>(chunk + offset));
+                    }
+
+                    return true;
+                }
+
+            private:
+                std::mutex mutex;
+                std::array<free_list, size_class_count> lists;
+                free_block* chunks = nullptr;
+                unsigned long long chunk_count = 0;
+                thread_cache* caches = nullptr;
+                pool_statistics retired{};
+            };
+
+            static std::size_t size_class_of(std::size_t size) noexcept
+            {
+                return size == 0 ? 0 : (size - 1) / granularity;
+            }
+
+            //! Deliberately leaked, with its chunks, so that it outlives every static and `thread_local` that uses the pool.
+            static shared_heap& shared()
+            {
+                static shared_heap* const heap = new shared_heap{};
+                return *heap;
+            }
+
+            static thread_cache& local_cache()
+            {
+                thread_local thread_cache cache;
+                return cache;
+            }
+
+            //! Set once the calling thread's cache is destroyed. A trivial `thread_local`, so that it is never destroyed itself.
+            static inline thread_local bool cache_destroyed = false;
+        };
+
+        //! Base class that makes `new` and `delete` of `Class` use `memory_pool`.
+        //! `Class` must be the most derived type of every object allocated this way,
+        //! so that the size passed to `operator delete` matches the size that was allocated.
+        //! If another base of `Class` also declares `operator new`, as WRL's `RuntimeClass` does, `new Class` is ambiguous;
+        //! allocate with `create` instead.
+        template <typename Class>
+        class pooled_allocation
+        {
+        public:
+            //! Allocate a `Class` from the pool and construct it from `args`, or return null if the pool is out of memory.
+            template <typename... Args>
+            static Class* create(Args&&... args)
+            {
+                const auto block = pooled_allocation::operator new(sizeof(Class), std::nothrow);
+                if (block == nullptr)
+                {
+                    return nullptr;
+                }
+
+                try
+                {
+                    return ::new (block) Class{ std::forward<Args>(args)... };
+                }
+                catch (...)
+                {
+                    pooled_allocation::operator delete(block, std::nothrow);
+                    throw;
+                }
+            }
+
+            static void* operator new(std::size_t size)
+            {
+                static_assert(alignof(Class) <= memory_pool::granularity, "memory_pool does not support over-aligned types");
+
+                const auto block = memory_pool::allocate(size);
+                if (block == nullptr)
+                {
+                    throw std::bad_alloc{};
+                }
+
+                return block;
+            }
+
+            static void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+            {
+                static_assert(alignof(Class) <= memory_pool::granularity, "memory_pool does not support over-aligned types");
+
+                return memory_pool::allocate(size);
+            }
+
+            static void operator delete(void* block, std::size_t size) noexcept
+            {
+                memory_pool::deallocate(block, size);
+            }
+
+            //! Called if the constructor throws after `new (std::nothrow)`.
+            static void operator delete(void* block, const std::nothrow_t&) noexcept
+            {
+                memory_pool::deallocate(block, sizeof(Class));
+            }
+        };
+
+        //! Whether `Class` opted in to `memory_pool` by deriving from `pooled_allocation<Class>`.
+        template <typename Class>
+        constexpr bool is_pooled = std::is_base_of<pooled_allocation<Class>, Class>::value;
+    }
+}
@@ -1,36 +1,79 @@
 #pragma once
 
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <utility>
 
 namespace windows
 {
     //! A strongly typed, immutable wrapper for a string representing an NTFS path.
-    class path
+    //! `Allocator` allocates the string; see `windows::path` and `windows::pmr::path`.
+    template <typename Allocator = std::allocator<wchar_t>>
+    class basic_path
     {
     public:
-        path(std::wstring str) :
+        using string_type = std::basic_string<wchar_t, std::char_traits<wchar_t>, Allocator>;
+        using allocator_type = Allocator;
+
+        basic_path(string_type str) :
             str{ std::move(str) }
         {
         }
 
-        path(const path&) = default;
-        path(path&&) = default;
+        basic_path(std::wstring_view str, const Allocator& allocator) :
+            str{ str, allocator }
+        {
+        }
+
+        //! Copies keep the allocator of `other`, so that a path built in an arena stays there.
+        //! There is no separate move constructor, since `str` cannot be moved from.
+        basic_path(const basic_path& other) :
+            str{ other.str, other.str.get_allocator() }
+        {
+        }
+
+        //! Copy `other` with a different allocator, for containers that pass their allocator to their elements.
+        basic_path(const basic_path& other, const Allocator& allocator) :
+            str{ other.str, allocator }
+        {
+        }
 
-        path& operator=(const path&) = delete;
-        path& operator=(path&&) = delete;
+        basic_path& operator=(const basic_path&) = delete;
+        basic_path& operator=(basic_path&&) = delete;
 
         const wchar_t* c_str() const
         {
             return str.c_str();
         }
 
+        allocator_type get_allocator() const
+        {
+            return str.get_allocator();
+        }
+
     public:
-        const std::wstring str;
+        const string_type str;
     };
 
-    inline path operator/(const path& path, const std::wstring& str)
+    using path = basic_path<>;
+
+    namespace pmr
+    {
+        //! A path whose string is allocated from a `std::pmr::memory_resource`.
+        using path = basic_path<std::pmr::polymorphic_allocator<wchar_t>>;
+    }
+
+    //! Join two paths with a backslash. The result uses the allocator of `path`.
+    template <typename Allocator>
+    basic_path<Allocator> operator/(const basic_path<Allocator>& path, std::wstring_view str)
     {
-        return path.str + L"\\" + str;
+        typename basic_path<Allocator>::string_type result{ path.get_allocator() };
+        result.reserve(path.str.size() + 1 + str.size());
+        result += path.str;
+        result += L'\\';
+        result += str;
+        return result;
     }
-}
+}
\ No newline at end of file
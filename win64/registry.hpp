@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <optional>
+#include <string>
 
 #include <winreg.h>
 
@@ -8,6 +10,7 @@
 #include "ktm.hpp"
 #include "locale.hpp"
 #include "path.hpp"
+#include "trace.hpp"
 
 namespace windows
 {
@@ -51,13 +54,15 @@ namespace windows
         using unique_key = windows::unique_handle<detail::registry_key_traits>;
 
         //! Wraps a call to `RegCreateKeyTransacted`.
-        inline unique_key create_key(hive parent, const windows::path& path, REGSAM access_rights, const windows::ktm::transaction& transaction)
+        inline unique_key create_key(hive parent, const wchar_t* path, REGSAM access_rights, const windows::ktm::transaction& transaction)
         {
-            HKEY result;
+            WIN64_TRACE_SPAN(windows::trace::event_id::registry_create_key, parent);
+
+            HKEY result = nullptr;
 
             windows::throw_if_failed(::RegCreateKeyTransacted(
                 hkey(parent),
-                path.c_str(),
+                path,
                 0,
                 nullptr,
                 REG_OPTION_NON_VOLATILE,
@@ -71,16 +76,28 @@ namespace windows
             return unique_key{ result };
         }
 
+        inline unique_key create_key(hive parent, const windows::path& path, REGSAM access_rights, const windows::ktm::transaction& transaction)
+        {
+            return create_key(parent, path.c_str(), access_rights, transaction);
+        }
+
+        inline unique_key create_key(hive parent, const windows::pmr::path& path, REGSAM access_rights, const windows::ktm::transaction& transaction)
+        {
+            return create_key(parent, path.c_str(), access_rights, transaction);
+        }
+
         //! Wraps a call to `RegOpenKeyTransacted`.
         //! Returns `nullopt` if the key does not exist.
         //! Throws `hresult_exception` on any other error.
-        inline std::optional<unique_key> open_key(hive parent, const windows::path& path, REGSAM access_rights, const windows::ktm::transaction& transaction)
+        inline std::optional<unique_key> open_key(hive parent, const wchar_t* path, REGSAM access_rights, const windows::ktm::transaction& transaction)
         {
-            HKEY result;
+            WIN64_TRACE_SPAN(windows::trace::event_id::registry_open_key, parent);
+
+            HKEY result = nullptr;
 
             const auto status = ::RegOpenKeyTransacted(
                 hkey(parent),
-                path.c_str(),
+                path,
                 0,
                 access_rights,
                 &result,
@@ -101,22 +118,44 @@ namespace windows
             }
         }
 
-        //! Set the value `value_name` under key `key` to `value_data`, or set the default value if the value is not given.
+        inline std::optional<unique_key> open_key(hive parent, const windows::path& path, REGSAM access_rights, const windows::ktm::transaction& transaction)
+        {
+            return open_key(parent, path.c_str(), access_rights, transaction);
+        }
+
+        inline std::optional<unique_key> open_key(hive parent, const windows::pmr::path& path, REGSAM access_rights, const windows::ktm::transaction& transaction)
+        {
+            return open_key(parent, path.c_str(), access_rights, transaction);
+        }
+
+        //! Set the value `value_name` under key `key` to the `size` characters at `value_data`, which must be null-terminated,
+        //! or set the default value if `value_name` is null.
         //! Wraps a call to `RegSetValueEx`.
-        inline void set_value_string(HKEY key, const std::optional<std::wstring>& value_name, const std::wstring& value_data)
+        inline void set_value_string(HKEY key, const wchar_t* value_name, const wchar_t* value_data, std::size_t size)
         {
+            WIN64_TRACE_SPAN(windows::trace::event_id::registry_set_value, size);
+
+            // `REG_SZ` data is measured in bytes and includes the terminating null.
             windows::throw_if_failed(::RegSetValueEx(
                 key,
-                !value_name ? nullptr : value_name->c_str(),
+                value_name,
                 0,
                 REG_SZ,
-                reinterpret_cast<const BYTE*>(value_data.c_str()),
-                static_cast<DWORD>(value_data.size())));
+                reinterpret_cast<const BYTE*>(value_data),
+                static_cast<DWORD>((size + 1) * sizeof(wchar_t))));
+        }
+
+        //! Set the value `value_name` under key `key` to `value_data`, or set the default value if the value is not given.
+        inline void set_value_string(HKEY key, const std::optional<std::wstring>& value_name, const std::wstring& value_data)
+        {
+            set_value_string(key, !value_name ? nullptr : value_name->c_str(), value_data.c_str(), value_data.size());
         }
 
         //! Opens the given key and calls `RegDeleteTree`.
-        inline void delete_subtree(hive parent, const windows::path& path, const windows::ktm::transaction& transaction)
+        inline void delete_subtree(hive parent, const wchar_t* path, const windows::ktm::transaction& transaction)
         {
+            WIN64_TRACE_SPAN(windows::trace::event_id::registry_delete_subtree, parent);
+
             const auto access_rights = DELETE | KEY_ENUMERATE_SUB_KEYS | KEY_QUERY_VALUE | KEY_SET_VALUE; // access rights for `RegDeleteTree`
             const auto key = registry::open_key(parent, path, access_rights, transaction);
 
@@ -130,5 +169,15 @@ namespace windows
                 throw_if_failed(::RegDeleteTree(key->get(), nullptr));
             }
         }
+
+        inline void delete_subtree(hive parent, const windows::path& path, const windows::ktm::transaction& transaction)
+        {
+            delete_subtree(parent, path.c_str(), transaction);
+        }
+
+        inline void delete_subtree(hive parent, const windows::pmr::path& path, const windows::ktm::transaction& transaction)
+        {
+            delete_subtree(parent, path.c_str(), transaction);
+        }
     }
 }
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "ktm.hpp"
+#include "path.hpp"
+#include "registry.hpp"
+
+namespace windows
+{
+    namespace com
+    {
+        namespace server
+        {
+            //! Information for a registry entry that is created upon registration of this COM server
+            //! `Allocator` allocates the strings; see `registry_entry` and `pmr::registry_entry`.
+            template <typename Allocator = std::allocator<wchar_t>>
+            struct basic_registry_entry
+            {
+                using string_type = typename windows::basic_path<Allocator>::string_type;
+
+                windows::basic_path<Allocator> path;
+                bool delete_on_unregister;
+                std::optional<string_type> name; //!< Default keys in the registry do not have names.
+                std::optional<string_type> value; //!< COM doesn't need this, just for humans
+            };
+
+            //! Handles registration and unregistration for the DLL.
+            //! The entries are kept in a `std::vector` with the entries' allocator.
+            template <typename Allocator = std::allocator<wchar_t>>
+            class basic_server_registrar
+            {
+            public:
+                using entry_type = basic_registry_entry<Allocator>;
+                using container_type = std::vector<entry_type, typename std::allocator_traits<Allocator>::template rebind_alloc<entry_type>>;
+
+                // TODO template for any 'range' type
+                basic_server_registrar(container_type entries, windows::registry::hive hive = windows::registry::hive::local_machine) :
+                    entries{ std::move(entries) },
+                    hive{ hive }
+                {
+                }
+
+                //! Transactionally remove all entries marked for deletion on unregistration.
+                void unregister_entries() const
+                {
+                    windows::ktm::transact([this](const windows::ktm::transaction& t) { _unregister_entries(t); });
+                }
+
+                //! Transactionally create all entries specified in `entries`.
+                void register_entries() const
+                {
+                    windows::ktm::transact([this](const windows::ktm::transaction& t) { _register_entries(t); });
+                }
+
+            private:
+                void _unregister_entries(const windows::ktm::transaction& transaction) const
+                {
+                    for (const auto& entry : entries)
+                    {
+                        if (entry.delete_on_unregister) windows::registry::delete_subtree(hive, entry.path.c_str(), transaction);
+                        else continue;
+                    }
+                }
+
+                void _register_entries(const ktm::transaction& transaction) const
+                {
+                    _unregister_entries(transaction);
+
+                    for (const auto& entry : entries)
+                    {
+                        const auto key = windows::registry::create_key(hive, entry.path.c_str(), KEY_WRITE, transaction);
+
+                        if (entry.value)
+                        {
+                            windows::registry::set_value_string(key.get(), !entry.name ? nullptr : entry.name->c_str(), entry.value->c_str(), entry.value->size());
+                        }
+                    }
+                }
+
+            private:
+                container_type entries;
+                windows::registry::hive hive;
+            };
+
+            using registry_entry = basic_registry_entry<>;
+            using server_registrar = basic_server_registrar<>;
+
+            namespace pmr
+            {
+                //! A registry entry whose strings are allocated from a `std::pmr::memory_resource`.
+                //! Build the path and strings from the same resource, such as a `windows::memory::scoped_arena`;
+                //! the entry does not propagate its allocator to them.
+                using registry_entry = basic_registry_entry<std::pmr::polymorphic_allocator<wchar_t>>;
+                using server_registrar = basic_server_registrar<std::pmr::polymorphic_allocator<wchar_t>>;
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <vector>
 
 #include "error.hpp"
+#include "telemetry.hpp"
+#include "trace.hpp"
 
 namespace windows
 {
@@ -11,8 +13,20 @@ namespace windows
     {
         struct timeout_wexception : public windows::wexception {};
 
+        namespace detail
+        {
+            //! Count a timed-out wait in `windows::telemetry` and throw.
+            [[noreturn]] inline void throw_timeout()
+            {
+                telemetry::record_failure(telemetry::failure_source::timeout, HRESULT_FROM_WIN32(WAIT_TIMEOUT));
+                throw timeout_wexception{};
+            }
+        }
+
         inline void wait(HANDLE object, unsigned long timeout = INFINITE)
         {
+            WIN64_TRACE_SPAN(windows::trace::event_id::wait, timeout);
+
             const auto result = ::WaitForSingleObject(object, timeout);
 
             if (result == WAIT_ABANDONED)
@@ -23,7 +37,7 @@ namespace windows
             }
             else if (result == WAIT_TIMEOUT)
             {
-                throw timeout_wexception{};
+                detail::throw_timeout();
             }
             else if (result == WAIT_FAILED)
             {
@@ -33,6 +47,8 @@ namespace windows
 
         inline void wait_for_all(const std::vector<HANDLE>& objects, unsigned long timeout = INFINITE)
         {
+            WIN64_TRACE_SPAN(windows::trace::event_id::wait_for_all, objects.size());
+
             const auto events = ::WaitForMultipleObjects(
                 objects.size(),
                 objects.data(),
@@ -46,7 +62,7 @@ namespace windows
             }
             else if (events == WAIT_TIMEOUT)
             {
-                throw timeout_wexception{};
+                detail::throw_timeout();
             }
             else
             {
@@ -58,6 +74,8 @@ namespace windows
         //! (abandoned mutexes also count).
         inline HANDLE wait_for_any(const std::vector<HANDLE>& objects, unsigned long timeout = INFINITE)
         {
+            WIN64_TRACE_SPAN(windows::trace::event_id::wait_for_any, objects.size());
+
             const auto events = ::WaitForMultipleObjects(
                 objects.size(),
                 objects.data(),
@@ -76,7 +94,7 @@ namespace windows
             }
             else if (events == WAIT_TIMEOUT)
             {
-                throw timeout_wexception{};
+                detail::throw_timeout();
             }
             else
             {
@@ -0,0 +1,297 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace windows
+{
+    namespace telemetry
+    {
+        //! Where a failure was observed.
+        enum class failure_source
+        {
+            throw_if_failed, //!< `windows::throw_if_failed` was given a failed error code
+            exception, //!< A `windows::win32_wexception` was constructed
+            entry_point, //!< `windows::com::server::entry_point` converted an exception to a failed `HRESULT`
+            timeout //!< A `windows::synchronization` wait timed out
+        };
+
+        constexpr std::size_t failure_source_count = 4;
+
+        //! The number of failures with a given `HRESULT` observed at a given source.
+        struct failure_count
+        {
+            long hresult; //!< 0 for failures that did not fit in their thread's table (see `record_failure`)
+            failure_source source;
+            unsigned long long count;
+        };
+
+        namespace detail
+        {
+            constexpr std::size_t cache_line_size = 64;
+
+            //! One `HRESULT` in a `failure_table`, padded so that adjacent slots do not share a cache line.
+            struct alignas(cache_line_size) failure_slot
+            {
+                std::atomic<long> hresult{ 0 }; //!< 0 while the slot is unused
+                std::array<std::atomic<unsigned long long>, failure_source_count> counts{};
+            };
+
+            //! Failure counters for one thread.
+            //! Only the owning thread writes to the table, so updates are plain loads and stores;
+            //! the counters are atomic only so that `snapshot` can read them from another thread.
+            struct alignas(cache_line_size) failure_table
+            {
+                static constexpr std::size_t capacity = 64;
+
+                std::array<failure_slot, capacity> slots;
+                failure_slot overflow;
+                failure_table* previous = nullptr;
+                failure_table* next = nullptr;
+
+                void record(failure_source source, long hresult) noexcept
+                {
+                    auto& slot = find(hresult);
+                    auto& count = slot.counts[static_cast<std::size_t>(source)];
+                    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                }
+
+            private:
+                failure_slot& find(long hresult) noexcept
+                {
+                    if (hresult == 0)
+                    {
+                        return overflow;
+                    }
+
+                    const auto hash = static_cast<std::uint32_t>(hresult) * 0x9E3779B9u;
+                    for (std::size_t probe = 0; probe < capacity; ++probe)
+                    {
+                        auto& slot = slots[(hash + probe) % capacity];
+                        const auto key = slot.hresult.load(std::memory_order_relaxed);
+
+                        if (key == hresult)
+                        {
+                            return slot;
+                        }
+                        else if (key == 0)
+                        {
+                            slot.hresult.store(hresult, std::memory_order_release);
+                            return slot;
+                        }
+                    }
+
+                    return overflow;
+                }
+            };
+
+            //! Aggregates the tables of all threads.
+            //! The lock is only taken when a thread records its first failure, when it exits, and by `snapshot`.
+            class failure_registry
+            {
+            public:
+                void attach(failure_table* table)
+                {
+                    const std::lock_guard<std::mutex> lock{ mutex };
+
+                    table->next = tables;
+                    if (tables != nullptr)
+                    {
+                        tables->previous = table;
+                    }
+                    tables = table;
+                }
+
+                //! Fold the counts of an exiting thread into `retired`.
+                void detach(failure_table* table)
+                {
+                    const std::lock_guard<std::mutex> lock{ mutex };
+
+                    add(retired, *table);
+                    merge(retired);
+
+                    (table->previous != nullptr ? table->previous->next : tables) = table->next;
+                    if (table->next != nullptr)
+                    {
+                        table->next->previous = table->previous;
+                    }
+                }
+
+                //! Allocates the result once, unless a thread starts counting another `HRESULT` while it is gathered.
+                std::vector<failure_count> snapshot()
+                {
+                    std::vector<failure_count> result;
+                    {
+                        const std::lock_guard<std::mutex> lock{ mutex };
+
+                        auto size = retired.size();
+                        for (auto table = tables; table != nullptr; table = table->next)
+                        {
+                            size += used(*table);
+                        }
+
+                        result.reserve(size);
+                        result.insert(result.end(), retired.begin(), retired.end());
+                        for (auto table = tables; table != nullptr; table = table->next)
+                        {
+                            add(result, *table);
+                        }
+                    }
+
+                    merge(result);
+                    return result;
+                }
+
+            private:
+                //! Nonzero counts in `table`.
+                static std::size_t used(const failure_table& table)
+                {
+                    std::size_t size = 0;
+                    const auto count = [&size](const failure_slot& slot)
+                    {
+                        for (const auto& c : slot.counts)
+                        {
+                            size += c.load(std::memory_order_relaxed) != 0 ? 1 : 0;
+                        }
+                    };
+
+                    for (const auto& slot : table.slots)
+                    {
+                        if (slot.hresult.load(std::memory_order_acquire) != 0)
+                        {
+                            count(slot);
+                        }
+                    }
+
+                    count(table.overflow);
+                    return size;
+                }
+
+                static void add(std::vector<failure_count>& counts, const failure_slot& slot, long hresult)
+                {
+                    for (std::size_t source = 0; source < failure_source_count; ++source)
+                    {
+                        const auto count = slot.counts[source].load(std::memory_order_relaxed);
+                        if (count != 0)
+                        {
+                            counts.push_back(failure_count{ hresult, static_cast<failure_source>(source), count });
+                        }
+                    }
+                }
+
+                static void add(std::vector<failure_count>& counts, const failure_table& table)
+                {
+                    for (const auto& slot : table.slots)
+                    {
+                        const auto hresult = slot.hresult.load(std::memory_order_acquire);
+                        if (hresult != 0)
+                        {
+                            add(counts, slot, hresult);
+                        }
+                    }
+
+                    add(counts, table.overflow, 0);
+                }
+
+                //! Sort `counts` by `HRESULT` and source, and add up the counts of each pair, in place.
+                static void merge(std::vector<failure_count>& counts)
+                {
+                    const auto key = [](const failure_count& c) { return std::make_pair(c.hresult, c.source); };
+                    std::sort(counts.begin(), counts.end(), [&key](const failure_count& a, const failure_count& b)
+                    {
+                        return key(a) < key(b);
+                    });
+
+                    auto last = counts.begin();
+                    for (auto i = counts.begin(); i != counts.end(); ++i)
+                    {
+                        if (last != counts.begin() && key(*std::prev(last)) == key(*i))
+                        {
+                            std::prev(last)->count += i->count;
+                        }
+                        else
+                        {
+                            *last++ = *i;
+                        }
+                    }
+
+                    counts.erase(last, counts.end());
+                }
+
+            private:
+                std::mutex mutex;
+                failure_table* tables = nullptr;
+                std::vector<failure_count> retired; //!< Counts of exited threads, merged
+            };
+
+            inline failure_registry& registry()
+            {
+                static failure_registry instance;
+                return instance;
+            }
+
+            //! Owns the calling thread's table, which is only created when the thread records its first failure.
+            struct thread_failures
+            {
+                failure_table* table = nullptr;
+
+                ~thread_failures()
+                {
+                    if (table != nullptr)
+                    {
+                        registry().detach(table);
+                        delete table;
+                    }
+                }
+
+                failure_table* get() noexcept
+                {
+                    if (table == nullptr)
+                    {
+                        try
+                        {
+                            auto created = new failure_table{};
+                            registry().attach(created);
+                            table = created;
+                        }
+                        catch (...)
+                        {
+                            // Telemetry must never turn one failure into another.
+                        }
+                    }
+
+                    return table;
+                }
+            };
+        }
+
+        //! Count a failure with the given `HRESULT`.
+        //! Only call this on failure paths: the first call on each thread allocates that thread's table.
+        //! Each thread counts up to `detail::failure_table::capacity` distinct `HRESULT`s;
+        //! failures with any further `HRESULT`s are counted under `hresult` 0.
+        inline void record_failure(failure_source source, long hresult) noexcept
+        {
+            thread_local detail::thread_failures failures;
+
+            const auto table = failures.get();
+            if (table != nullptr)
+            {
+                table->record(source, hresult);
+            }
+        }
+
+        //! Get the failure counts of all threads, including threads that have exited, sorted by `HRESULT` and source.
+        //! Counts only ever increase, so a metrics exporter can report the difference between two snapshots.
+        inline std::vector<failure_count> snapshot()
+        {
+            return detail::registry().snapshot();
+        }
+    }
+}
@@ -0,0 +1,502 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+//! Binary event tracing.
+//!
+//! Events are recorded into a lock-free ring buffer owned by the recording thread,
+//! and a background thread started by `windows::trace::session` writes them to a file.
+//! The `win64.trace` tool decodes the file to text or to Chrome's trace event JSON (chrome://tracing).
+//!
+//! The `WIN64_TRACE_SPAN` and `WIN64_TRACE_EVENT` macros compile to nothing unless `WIN64_TRACING` is defined.
+//! When it is defined but no session is running, each event costs one relaxed atomic load.
+//! Define it for the whole program, as a compiler option (`target_compile_definitions` in CMake), never in a source file:
+//! the macros are used in inline functions such as `windows::registry::set_value_string`, which must be the same
+//! in every translation unit. MSVC's linker reports a mismatch.
+
+namespace windows
+{
+    namespace trace
+    {
+        //! Identifies what an event describes.
+        //! IDs below `user` are reserved for the instrumentation in this library.
+        enum class event_id : std::uint32_t
+        {
+            ktm_transact = 1, //!< `windows::ktm::transact`
+            registry_create_key, //!< `windows::registry::create_key`; payload is the hive
+            registry_open_key, //!< `windows::registry::open_key`; payload is the hive
+            registry_set_value, //!< `windows::registry::set_value_string`; payload is the data length
+            registry_delete_subtree, //!< `windows::registry::delete_subtree`; payload is the hive
+            wait, //!< `windows::synchronization::wait`; payload is the timeout
+            wait_for_all, //!< `windows::synchronization::wait_for_all`; payload is the number of objects
+            wait_for_any, //!< `windows::synchronization::wait_for_any`; payload is the number of objects
+            user = 0x10000 //!< First ID available to applications
+        };
+
+        enum class event_kind : std::uint32_t
+        {
+            begin,
+            end,
+            instant
+        };
+
+        //! A fixed-size binary event, written to the trace file as-is.
+        struct event
+        {
+            std::uint64_t timestamp; //!< Nanoseconds of `std::chrono::steady_clock`
+            std::uint32_t id; //!< An `event_id`
+            event_kind kind;
+            std::uint64_t payload;
+        };
+
+        static_assert(sizeof(event) == 24, "trace events must have a fixed layout");
+
+        //! Name of a library `event_id`, or `nullptr` for user IDs.
+        inline const char* event_name(std::uint32_t id)
+        {
+            switch (static_cast<event_id>(id))
+            {
+            case event_id::ktm_transact: return "ktm::transact";
+            case event_id::registry_create_key: return "registry::create_key";
+            case event_id::registry_open_key: return "registry::open_key";
+            case event_id::registry_set_value: return "registry::set_value_string";
+            case event_id::registry_delete_subtree: return "registry::delete_subtree";
+            case event_id::wait: return "synchronization::wait";
+            case event_id::wait_for_all: return "synchronization::wait_for_all";
+            case event_id::wait_for_any: return "synchronization::wait_for_any";
+            default: return nullptr;
+            }
+        }
+
+        //! Single-producer, single-consumer ring of events.
+        //! The owning thread pushes; the flusher drains. When the ring is full, new events are dropped and counted.
+        class ring_buffer
+        {
+        public:
+            static constexpr std::size_t capacity = 4096;
+
+            explicit ring_buffer(std::uint32_t thread) :
+                thread{ thread }
+            {
+            }
+
+            bool push(const event& e) noexcept
+            {
+                const auto h = head.load(std::memory_order_relaxed);
+                if (h - tail.load(std::memory_order_acquire) == capacity)
+                {
+                    dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    return false;
+                }
+
+                events[h % capacity] = e;
+                head.store(h + 1, std::memory_order_release);
+                return true;
+            }
+
+            //! Call `consume(const event*, size_t)` with the events pushed so far, in at most two contiguous runs.
+            template <typename Consumer>
+            std::size_t drain(Consumer&& consume)
+            {
+                const auto t = tail.load(std::memory_order_relaxed);
+                const auto h = head.load(std::memory_order_acquire);
+                const auto n = static_cast<std::size_t>(h - t);
+                const auto start = static_cast<std::size_t>(t % capacity);
+                const auto first = std::min(n, capacity - start);
+
+                if (first != 0)
+                {
+                    consume(&events[start], first);
+                }
+                if (n != first)
+                {
+                    consume(&events[0], n - first);
+                }
+
+                tail.store(h, std::memory_order_release);
+                return n;
+            }
+
+            std::uint64_t dropped_events() const noexcept
+            {
+                return dropped.load(std::memory_order_relaxed);
+            }
+
+            const std::uint32_t thread;
+
+        private:
+            std::atomic<std::uint64_t> head{ 0 };
+            alignas(64) std::atomic<std::uint64_t> tail{ 0 };
+            alignas(64) std::atomic<std::uint64_t> dropped{ 0 };
+            event events[capacity];
+        };
+
+        namespace detail
+        {
+            //! Trace file layout: a `file_header`, then any number of blocks,
+            //! each a `block_header` followed by `block_header::count` events from one thread.
+            struct file_header
+            {
+                char magic[8]; //!< "W64TRACE"
+                std::uint32_t version;
+                std::uint32_t event_size;
+            };
+
+            struct block_header
+            {
+                std::uint32_t thread;
+                std::uint32_t count;
+            };
+
+            constexpr char magic[8] = { 'W', '6', '4', 'T', 'R', 'A', 'C', 'E' };
+            constexpr std::uint32_t version = 1;
+
+            inline std::uint64_t now() noexcept
+            {
+                const auto since_epoch = std::chrono::steady_clock::now().time_since_epoch();
+                return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch).count());
+            }
+
+            //! The ring buffers of all threads that have recorded events.
+            //! A ring outlives its thread until the flusher has drained it.
+            class ring_registry
+            {
+            public:
+                std::shared_ptr<ring_buffer> create()
+                {
+                    const std::lock_guard<std::mutex> lock{ mutex };
+                    rings.push_back(std::make_shared<ring_buffer>(next_thread++));
+                    return rings.back();
+                }
+
+                //! Drain every ring into `output` and forget the rings whose threads have exited.
+                void flush(std::ostream& output)
+                {
+                    std::vector<std::shared_ptr<ring_buffer>> current;
+                    std::vector<bool> exited;
+                    {
+                        const std::lock_guard<std::mutex> lock{ mutex };
+                        for (const auto& ring : rings)
+                        {
+                            // Once its thread has exited, only the registry holds a ring.
+                            exited.push_back(ring.use_count() == 1);
+                        }
+                        current = rings;
+                    }
+
+                    for (const auto& ring : current)
+                    {
+                        ring->drain([&](const event* events, std::size_t count)
+                        {
+                            const block_header header{ ring->thread, static_cast<std::uint32_t>(count) };
+                            output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                            output.write(reinterpret_cast<const char*>(events), static_cast<std::streamsize>(count * sizeof(event)));
+                        });
+                    }
+
+                    const std::lock_guard<std::mutex> lock{ mutex };
+                    for (std::size_t i = 0; i < current.size(); ++i)
+                    {
+                        if (exited[i])
+                        {
+                            retired_dropped += current[i]->dropped_events();
+                            rings.erase(std::find(rings.begin(), rings.end(), current[i]));
+                        }
+                    }
+                }
+
+                std::uint64_t dropped_events()
+                {
+                    const std::lock_guard<std::mutex> lock{ mutex };
+                    std::uint64_t total = retired_dropped;
+                    for (const auto& ring : rings)
+                    {
+                        total += ring->dropped_events();
+                    }
+                    return total;
+                }
+
+            private:
+                std::mutex mutex;
+                std::vector<std::shared_ptr<ring_buffer>> rings;
+                std::uint32_t next_thread = 1;
+                std::uint64_t retired_dropped = 0;
+            };
+
+            inline ring_registry& registry()
+            {
+                static ring_registry instance;
+                return instance;
+            }
+
+            //! Set while a `session` owns the rings, from before its flusher starts until after its final drain.
+            inline std::atomic<bool>& active()
+            {
+                static std::atomic<bool> value{ false };
+                return value;
+            }
+
+            //! Set while events are being recorded. Cleared before `active`, so that the final drain sees every event.
+            inline std::atomic<bool>& recording()
+            {
+                static std::atomic<bool> value{ false };
+                return value;
+            }
+
+            inline ring_buffer* local_ring()
+            {
+                thread_local std::shared_ptr<ring_buffer> ring = registry().create();
+                return ring.get();
+            }
+        }
+
+        //! Record an event on the calling thread if a `session` is running.
+        inline void emit(std::uint32_t id, event_kind kind, std::uint64_t payload = 0) noexcept
+        {
+            if (!detail::recording().load(std::memory_order_relaxed))
+            {
+                return;
+            }
+
+            try
+            {
+                detail::local_ring()->push(event{ detail::now(), id, kind, payload });
+            }
+            catch (...)
+            {
+                // Creating the calling thread's ring failed; tracing must not affect the traced code.
+            }
+        }
+
+        inline void emit(event_id id, event_kind kind, std::uint64_t payload = 0) noexcept
+        {
+            emit(static_cast<std::uint32_t>(id), kind, payload);
+        }
+
+        //! Records a `begin` event on construction and an `end` event on destruction.
+        class scoped_span
+        {
+        public:
+            template <typename Id>
+            scoped_span(Id id, std::uint64_t payload = 0) noexcept :
+                id{ static_cast<std::uint32_t>(id) }
+            {
+                emit(this->id, event_kind::begin, payload);
+            }
+
+            scoped_span(const scoped_span&) = delete;
+            scoped_span& operator=(const scoped_span&) = delete;
+
+            ~scoped_span()
+            {
+                emit(id, event_kind::end);
+            }
+
+        private:
+            std::uint32_t id;
+        };
+
+        //! Writes the events of all threads to a file from a background thread while it is alive.
+        //! Only one session may run at a time.
+        class session
+        {
+        public:
+            session(const std::string& path, std::chrono::milliseconds flush_interval = std::chrono::milliseconds{ 100 })
+            {
+                // Claim the session before touching the file, so that a second session cannot truncate the first one's.
+                if (detail::active().exchange(true))
+                {
+                    throw std::logic_error{ "a trace session is already running" };
+                }
+
+                // The destructor does not run if the constructor throws, so give the claim back here.
+                try
+                {
+                    output.open(path, std::ios::binary | std::ios::trunc);
+                    if (!output)
+                    {
+                        throw std::runtime_error{ "cannot open trace file " + path };
+                    }
+
+                    detail::file_header header{};
+                    std::memcpy(header.magic, detail::magic, sizeof(header.magic));
+                    header.version = detail::version;
+                    header.event_size = sizeof(event);
+                    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+                    flusher = std::thread{ [this, flush_interval]
+                    {
+                        std::unique_lock<std::mutex> lock{ mutex };
+                        while (!stopping)
+                        {
+                            stopped.wait_for(lock, flush_interval);
+                            detail::registry().flush(output);
+                        }
+                    } };
+
+                    detail::recording().store(true);
+                }
+                catch (...)
+                {
+                    detail::active().store(false);
+                    throw;
+                }
+            }
+
+            session(const session&) = delete;
+            session& operator=(const session&) = delete;
+
+            //! Stop recording, write the remaining events, and close the file.
+            ~session()
+            {
+                detail::recording().store(false);
+                {
+                    const std::lock_guard<std::mutex> lock{ mutex };
+                    stopping = true;
+                }
+                stopped.notify_one();
+                flusher.join();
+                detail::registry().flush(output);
+
+                // Only now may another session start draining the rings.
+                detail::active().store(false);
+            }
+
+            //! Events dropped so far because a thread's ring was full.
+            static std::uint64_t dropped_events()
+            {
+                return detail::registry().dropped_events();
+            }
+
+        private:
+            std::ofstream output;
+            std::mutex mutex;
+            std::condition_variable stopped;
+            bool stopping = false;
+            std::thread flusher;
+        };
+
+        //! An event read back from a trace file.
+        struct decoded_event
+        {
+            std::uint32_t thread;
+            event e;
+        };
+
+        //! Read all events from a trace file, ordered by timestamp.
+        //! Throws `std::runtime_error` if the file is not a trace file.
+        inline std::vector<decoded_event> read(std::istream& input)
+        {
+            detail::file_header header{};
+            if (!input.read(reinterpret_cast<char*>(&header), sizeof(header))
+                || std::memcmp(header.magic, detail::magic, sizeof(header.magic)) != 0
+                || header.version != detail::version
+                || header.event_size != sizeof(event))
+            {
+                throw std::runtime_error{ "not a trace file" };
+            }
+
+            std::vector<decoded_event> result;
+            detail::block_header block{};
+            while (input.read(reinterpret_cast<char*>(&block), sizeof(block)))
+            {
+                for (std::uint32_t i = 0; i < block.count; ++i)
+                {
+                    event e{};
+                    if (!input.read(reinterpret_cast<char*>(&e), sizeof(e)))
+                    {
+                        throw std::runtime_error{ "truncated trace file" };
+                    }
+                    result.push_back(decoded_event{ block.thread, e });
+                }
+            }
+
+            std::stable_sort(result.begin(), result.end(), [](const decoded_event& a, const decoded_event& b)
+            {
+                return a.e.timestamp < b.e.timestamp;
+            });
+
+            return result;
+        }
+
+        namespace detail
+        {
+            inline std::string display_name(std::uint32_t id)
+            {
+                const auto name = event_name(id);
+                return name != nullptr ? name : "event " + std::to_string(id);
+            }
+        }
+
+        //! Write one line per event: time in microseconds since the first event, thread, kind, name, and payload.
+        inline void write_text(std::ostream& output, const std::vector<decoded_event>& events)
+        {
+            static const char* const kinds[] = { "begin", "end", "instant" };
+            const auto origin = events.empty() ? 0 : events.front().e.timestamp;
+            for (const auto& d : events)
+            {
+                output << (d.e.timestamp - origin) / 1000.0 << " us\tthread " << d.thread << '\t'
+                    << kinds[static_cast<std::uint32_t>(d.e.kind) % 3] << '\t' << detail::display_name(d.e.id)
+                    << "\tpayload " << d.e.payload << '\n';
+            }
+        }
+
+        //! Write the events in Chrome's trace event format.
+        inline void write_chrome_json(std::ostream& output, const std::vector<decoded_event>& events)
+        {
+            static const char* const phases[] = { "B", "E", "i" };
+            const auto origin = events.empty() ? 0 : events.front().e.timestamp;
+            output << "{\"traceEvents\":[";
+            for (std::size_t i = 0; i < events.size(); ++i)
+            {
+                const auto& d = events[i];
+                output << (i == 0 ? "\n" : ",\n")
+                    << "{\"name\":\"" << detail::display_name(d.e.id)
+                    << "\",\"ph\":\"" << phases[static_cast<std::uint32_t>(d.e.kind) % 3]
+                    << "\",\"ts\":" << (d.e.timestamp - origin) / 1000.0
+                    << ",\"pid\":1,\"tid\":" << d.thread;
+                if (d.e.kind == event_kind::instant)
+                {
+                    output << ",\"s\":\"t\"";
+                }
+                output << ",\"args\":{\"payload\":" << d.e.payload << "}}";
+            }
+            output << "\n]}\n";
+        }
+    }
+}
+
+#define WIN64_TRACE_CONCAT_(a, b) a##b
+#define WIN64_TRACE_CONCAT(a, b) WIN64_TRACE_CONCAT_(a, b)
+
+#if defined(_MSC_VER)
+#if defined(WIN64_TRACING)
+#pragma detect_mismatch("WIN64_TRACING", "defined")
+#else
+#pragma detect_mismatch("WIN64_TRACING", "not defined")
+#endif
+#endif
+
+#if defined(WIN64_TRACING)
+//! Record a `begin` event now and an `end` event at the end of the enclosing scope.
+#define WIN64_TRACE_SPAN(id, payload) ::windows::trace::scoped_span WIN64_TRACE_CONCAT(win64_trace_span_, __LINE__){ (id), static_cast<std::uint64_t>(payload) }
+//! Record an `instant` event.
+#define WIN64_TRACE_EVENT(id, payload) ::windows::trace::emit((id), ::windows::trace::event_kind::instant, static_cast<std::uint64_t>(payload))
+#else
+#define WIN64_TRACE_SPAN(id, payload) ((void)0)
+#define WIN64_TRACE_EVENT(id, payload) ((void)0)
+#endif
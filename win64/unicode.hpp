@@ -0,0 +1,113 @@
+#pragma once
+
+namespace windows
+{
+    namespace locale
+    {
+        namespace detail
+        {
+            //! Decode one UTF-8 sequence at `p`.
+            //! Returns its length, 0 if `end` cuts it short, or -1 if it is invalid (in which case `c` is unspecified).
+            inline int decode_utf8(const unsigned char* p, const unsigned char* end, char32_t& c)
+            {
+                const auto lead = p[0];
+                int length;
+                char32_t minimum;
+
+                if (lead < 0x80) { c = lead; return 1; }
+                else if ((lead & 0xE0) == 0xC0) { length = 2; minimum = 0x80; c = lead & 0x1F; }
+                else if ((lead & 0xF0) == 0xE0) { length = 3; minimum = 0x800; c = lead & 0x0F; }
+                else if ((lead & 0xF8) == 0xF0) { length = 4; minimum = 0x10000; c = lead & 0x07; }
+                else return -1;
+
+                for (int k = 1; k < length; ++k)
+                {
+                    if (p + k == end)
+                    {
+                        return 0;
+                    }
+                    else if ((p[k] & 0xC0) != 0x80)
+                    {
+                        return -1;
+                    }
+
+                    c = (c << 6) | (p[k] & 0x3F);
+                }
+
+                return c < minimum || c > 0x10FFFF || (c >= 0xD800 && c < 0xE000) ? -1 : length;
+            }
+
+            //! Number of bytes in the UTF-8 encoding of `c`.
+            constexpr int utf8_length(char32_t c)
+            {
+                return c < 0x80 ? 1 : c < 0x800 ? 2 : c < 0x10000 ? 3 : 4;
+            }
+
+            //! Write the UTF-8 encoding of `c` at `out`. Returns the end of the encoding.
+            inline char* encode_utf8(char32_t c, char* out)
+            {
+                switch (utf8_length(c))
+                {
+                case 1:
+                    *out++ = static_cast<char>(c);
+                    break;
+                case 2:
+                    *out++ = static_cast<char>(0xC0 | (c >> 6));
+                    *out++ = static_cast<char>(0x80 | (c & 0x3F));
+                    break;
+                case 3:
+                    *out++ = static_cast<char>(0xE0 | (c >> 12));
+                    *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                    *out++ = static_cast<char>(0x80 | (c & 0x3F));
+                    break;
+                default:
+                    *out++ = static_cast<char>(0xF0 | (c >> 18));
+                    *out++ = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+                    *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                    *out++ = static_cast<char>(0x80 | (c & 0x3F));
+                    break;
+                }
+
+                return out;
+            }
+
+            //! Decode one UTF-16 code point at `p`. `Char` may be wider than 16 bits, as `wchar_t` is outside of Windows;
+            //! code units above 0xFFFF are then taken as whole code points.
+            //! Returns its length, or 0 if it is an unpaired surrogate or not a code point.
+            template <typename Char>
+            int decode_utf16(const Char* p, const Char* end, char32_t& c)
+            {
+                const auto unit = static_cast<char32_t>(p[0]);
+                if (unit >= 0xD800 && unit < 0xDC00 && p + 1 != end)
+                {
+                    const auto low = static_cast<char32_t>(p[1]);
+                    if (low >= 0xDC00 && low < 0xE000)
+                    {
+                        c = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                        return 2;
+                    }
+                }
+
+                c = unit;
+                return (unit >= 0xD800 && unit < 0xE000) || unit > 0x10FFFF ? 0 : 1;
+            }
+
+            //! Write the UTF-16 encoding of `c` at `out`. Returns the end of the encoding.
+            template <typename Char>
+            Char* encode_utf16(char32_t c, Char* out)
+            {
+                if (c < 0x10000)
+                {
+                    *out++ = static_cast<Char>(c);
+                }
+                else
+                {
+                    *out++ = static_cast<Char>(0xD800 + ((c - 0x10000) >> 10));
+                    *out++ = static_cast<Char>(0xDC00 + ((c - 0x10000) & 0x3FF));
+                }
+
+                return out;
+            }
+        }
+    }
+}
\ No newline at end of file